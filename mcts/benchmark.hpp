@@ -0,0 +1,572 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#if defined ( __linux__ )
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <boost/dynamic_bitset.hpp>
+
+#include "Typedefs.hpp"
+#include "Globals.hpp"
+#include "mcts.hpp"
+#include "pool_allocator.hpp"
+#include "uct_simd.hpp"
+
+
+namespace bench {
+
+    // Counts the (last level) cache misses of the calling thread, on Linux
+    // through perf_event_open. Elsewhere, or if the counter is not available
+    // (f.e. in a container), misses ( ) returns -1.
+
+    class CacheMisses {
+
+        int m_fd = -1;
+
+    public:
+
+        CacheMisses ( ) noexcept {
+#if defined ( __linux__ )
+            perf_event_attr attr { };
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof ( attr );
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_fd = ( int ) syscall ( __NR_perf_event_open, & attr, 0, -1, -1, 0 );
+#endif
+        }
+
+        ~CacheMisses ( ) noexcept {
+#if defined ( __linux__ )
+            if ( m_fd >= 0 ) {
+                close ( m_fd );
+            }
+#endif
+        }
+
+        void start ( ) noexcept {
+#if defined ( __linux__ )
+            if ( m_fd >= 0 ) {
+                ioctl ( m_fd, PERF_EVENT_IOC_RESET, 0 );
+                ioctl ( m_fd, PERF_EVENT_IOC_ENABLE, 0 );
+            }
+#endif
+        }
+
+        [[ nodiscard ]] std::int64_t misses ( ) noexcept {
+            std::int64_t misses = -1;
+#if defined ( __linux__ )
+            if ( m_fd >= 0 ) {
+                ioctl ( m_fd, PERF_EVENT_IOC_DISABLE, 0 );
+                if ( sizeof ( misses ) != read ( m_fd, & misses, sizeof ( misses ) ) ) {
+                    misses = -1;
+                }
+            }
+#endif
+            return misses;
+        }
+    };
+
+
+    using Clock = std::chrono::steady_clock;
+
+
+    // The selection phase in isolation: a tree is grown with iterations_
+    // iterations, after which no_descents_ descents (by UCT, from the root to
+    // a leaf) are timed, the cache misses are counted per selection step.
+
+    template<typename State, typename Layout>
+    void selection ( const char * name_, const index_t iterations_, const index_t no_descents_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        ( void ) mcts->compute ( state, iterations_ );
+        rng_t rng ( 91011u );
+        std::int64_t steps = 0;
+        CacheMisses cache_misses;
+        const Clock::time_point start = Clock::now ( );
+        cache_misses.start ( );
+        for ( index_t i = 0; i < no_descents_; ++i ) {
+            typename Mcts::NodeID node = mcts->m_tree.root_node;
+            while ( mcts->hasNoUntriedMoves ( node ) and mcts->hasChildren ( node ) ) {
+                node = mcts->selectChildUCT ( node, rng ).target;
+                ++steps;
+            }
+        }
+        const std::int64_t misses = cache_misses.misses ( );
+        const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        std::printf ( " %s: %lli nodes, %.1f ns/step, %.3f cache misses/step (%.1f KB)\n", name_, ( long long ) mcts->m_tree.nodeNum ( ), 1e9f * seconds / steps, misses < 0 ? -1.0f : misses / ( float ) steps, mcts->memory ( ) / 1'024.0f );
+        delete mcts;
+    }
+
+    template<typename State>
+    void layouts ( const index_t iterations_ = 1'000'000, const index_t no_descents_ = 1'000'000 ) noexcept {
+        std::printf ( " Selection, node statistics layouts\n" );
+        selection<State, mcts::ArrayOfStructs> ( "array of structs", iterations_, no_descents_ );
+        selection<State, mcts::StructOfArrays> ( "struct of arrays", iterations_, no_descents_ );
+        selection<State, mcts::ContiguousChildren> ( "contiguous children", iterations_, no_descents_ );
+    }
+
+
+    // A full serial search of iterations_ iterations from the initial position,
+    // reports the nodes (expansions), the iterations per second and the hits,
+    // misses and collisions of the transposition table.
+
+    template<typename State, typename Layout>
+    void search ( const char * name_, const index_t iterations_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        const Clock::time_point start = Clock::now ( );
+        ( void ) mcts->compute ( state, iterations_ );
+        const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        const auto counters = mcts->m_transposition_table->counters ( );
+        std::printf ( " %s: %lli nodes, %.0f nodes/s, %.0f iterations/s (%.1f KB), transpositions %llu hits, %llu misses, %llu collisions\n", name_, ( long long ) mcts->m_tree.nodeNum ( ), mcts->m_tree.nodeNum ( ) / seconds, iterations_ / seconds, mcts->memory ( ) / 1'024.0f, ( unsigned long long ) counters.hits, ( unsigned long long ) counters.misses, ( unsigned long long ) counters.collisions );
+        delete mcts;
+    }
+
+    template<typename State>
+    void trees ( const index_t iterations_ = 1'000'000 ) noexcept {
+        std::printf ( " Search, tree backends\n" );
+        search<State, mcts::ArrayOfStructs> ( "linked out-arcs", iterations_ );
+        search<State, mcts::ContiguousChildren> ( "contiguous children", iterations_ );
+    }
+
+
+    // Root and tree parallel searches of iterations_ iterations from the initial
+    // position, with 2, 4, ... up to the usable cores threads. The speedup is
+    // relative to a serial search of the same position, timed first.
+
+    template<typename State, typename Layout>
+    void parallel ( const index_t iterations_ = 1'000'000 ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        std::printf ( " Parallel search, speedup over a serial search\n" );
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * serial = new Mcts ( );
+        serial->seed ( 5678u );
+        serial->measureSerialBaseline ( state, mcts::Budget::iterations ( iterations_ ) );
+        const float serial_iterations_per_second = serial->m_serial_iterations_per_second;
+        delete serial;
+        for ( index_t no_threads = 2; no_threads <= topo::usableCores ( ); no_threads *= 2 ) {
+            Mcts * mcts = new Mcts ( );
+            mcts->seed ( 5678u );
+            mcts->setSerialBaseline ( serial_iterations_per_second );
+            ( void ) Mcts::computeRootParallel ( mcts, state, iterations_, no_threads );
+            mcts->m_search_stats.print ( "root parallel" );
+            delete mcts;
+            mcts = new Mcts ( );
+            mcts->seed ( 5678u );
+            mcts->setSerialBaseline ( serial_iterations_per_second );
+            ( void ) mcts->computeTreeParallel ( state, iterations_, no_threads );
+            mcts->m_search_stats.print ( "tree parallel" );
+            delete mcts;
+        }
+    }
+
+
+    // The memory per node of a tree grown with iterations_ iterations: the tree
+    // (Mcts::memory ( )) and the untried moves lists still held by its nodes
+    // (unless these are bitmasks).
+
+    template<typename State, typename Layout>
+    void nodesPerGB ( const char * name_, const index_t iterations_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        ( void ) mcts->compute ( state, iterations_ );
+        // Count the nodes holding a moves list, depth first.
+        const std::size_t no_nodes = mcts->m_tree.nodeNum ( );
+        boost::dynamic_bitset<> visited ( mcts->m_tree.nodesSize ( ) );
+        std::vector<typename Mcts::NodeID> stack { mcts->m_tree.root_node };
+        visited [ mcts->m_tree.root_node.value ] = true;
+        std::size_t no_moves_lists = 0u;
+        while ( stack.size ( ) ) {
+            const typename Mcts::NodeID node = stack.back ( ); stack.pop_back ( );
+            if constexpr ( not ( mcts::untried_bitmask<State>::value ) ) { // A bitmask is part of the node record.
+                no_moves_lists += mcts->hasUntriedMoves ( node );
+            }
+            for ( typename Mcts::cOutIt a = mcts->m_tree.cbeginOut ( node ); a.is_valid ( ); ++a ) {
+                if ( not ( visited [ a->target.value ] ) ) {
+                    visited [ a->target.value ] = true;
+                    stack.push_back ( a->target );
+                }
+            }
+        }
+        const std::size_t bytes = mcts->memory ( ) + no_moves_lists * sizeof ( typename State::Moves );
+        std::printf ( " %s: node record %zu bytes, %lli nodes, %.1f bytes/node, %.1fM nodes/GB\n", name_, sizeof ( typename Mcts::NodeData ), ( long long ) no_nodes, bytes / ( float ) no_nodes, ( 1 << 30 ) / ( bytes / ( float ) no_nodes ) / 1e6f );
+        delete mcts;
+    }
+
+    template<typename State>
+    void nodeEncodings ( const index_t iterations_ = 1'000'000 ) noexcept {
+        std::printf ( " Memory, node encodings\n" );
+        nodesPerGB<State, mcts::ArrayOfStructs> ( "array of structs", iterations_ );
+        nodesPerGB<State, mcts::ContiguousChildren> ( "contiguous children", iterations_ );
+        nodesPerGB<State, mcts::Compact> ( "compact", iterations_ );
+        search<State, mcts::Compact> ( "compact", iterations_ );
+    }
+
+
+    // A search of iterations_ iterations under a memory budget of budget_ bytes,
+    // against the unbounded search, the footprint should level off at the budget.
+
+    template<typename State, typename Layout>
+    void memoryBudget ( const index_t iterations_, const std::size_t budget_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        for ( const std::size_t budget : { std::size_t { 0 }, budget_ } ) {
+            seed ( 1234u );
+            State state;
+            state.initialize ( );
+            Mcts * mcts = new Mcts ( );
+            mcts->seed ( 5678u );
+            mcts->setMemoryBudget ( budget );
+            const Clock::time_point start = Clock::now ( );
+            const typename State::Move move = mcts->compute ( state, iterations_ );
+            const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+            std::printf ( " budget %.1f MB: %lli nodes, %lli evicted, live %.1f MB, held %.1f MB, %.0f iterations/s, move %i%s\n", budget / 1'048'576.0f, ( long long ) mcts->m_tree.nodeNum ( ), ( long long ) mcts->m_no_evicted_nodes, mcts->liveMemory ( ) / 1'048'576.0f, mcts->memory ( ) / 1'048'576.0f, iterations_ / seconds, ( int ) move.m_loc, mcts->m_search_stats.over_budget ? " (over budget)" : "" );
+            delete mcts;
+        }
+    }
+
+
+    // The pause of prune ( ... ) per move, over a game of self-play with
+    // iterations_ iterations per move.
+
+    template<typename State, typename Layout, bool InPlace>
+    void prunePause ( const char * name_, const index_t iterations_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        float total = 0.0f, max = 0.0f;
+        index_t no_moves = 0;
+        while ( not ( state.ended ( ) ) ) {
+            state.move_hash_winner ( mcts->compute ( state, iterations_ ) );
+            const Clock::time_point start = Clock::now ( );
+            Mcts::template prune<InPlace> ( mcts, state );
+            const float pause = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+            total += pause;
+            max = std::max ( max, pause );
+            ++no_moves;
+        }
+        std::printf ( " %s: %i moves, pause %.2f ms mean, %.2f ms max\n", name_, ( int ) no_moves, 1e3f * total / no_moves, 1e3f * max );
+        delete mcts;
+    }
+
+    template<typename State>
+    void prunes ( const index_t iterations_ = 200'000 ) noexcept {
+        std::printf ( " Prune, pause per move\n" );
+        prunePause<State, mcts::ContiguousChildren, false> ( "copy", iterations_ );
+        prunePause<State, mcts::ContiguousChildren, true> ( "in place", iterations_ );
+    }
+
+
+    // The throughput over a game of self-play (iterations_ iterations per move,
+    // the tree is pruned in place after every move and kept under a memory
+    // budget of budget_ bytes), with compaction in slices of slice_ nodes (0
+    // is off). Reports the iterations per second over the first and the second
+    // half of the moves.
+
+    template<typename State, typename Layout>
+    void session ( const char * name_, const index_t iterations_, const std::size_t budget_, const index_t slice_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        mcts->setMemoryBudget ( budget_ );
+        mcts->setCompaction ( slice_ );
+        std::vector<float> seconds;
+        while ( not ( state.ended ( ) ) ) {
+            const Clock::time_point start = Clock::now ( );
+            state.move_hash_winner ( mcts->compute ( state, iterations_ ) );
+            seconds.push_back ( std::chrono::duration<float> ( Clock::now ( ) - start ).count ( ) );
+            Mcts::prune ( mcts, state );
+        }
+        const std::size_t half = seconds.size ( ) / 2u;
+        float first = 0.0f, second = 0.0f;
+        for ( std::size_t i = 0u; i < seconds.size ( ); ++i ) {
+            ( i < half ? first : second ) += seconds [ i ];
+        }
+        std::printf ( " %s: %zu moves, first half %.0f iterations/s, second half %.0f iterations/s\n", name_, seconds.size ( ), half * iterations_ / first, ( seconds.size ( ) - half ) * iterations_ / second );
+        delete mcts;
+    }
+
+    template<typename State>
+    void compaction ( const index_t iterations_ = 200'000, const std::size_t budget_ = 16u * 1'048'576u ) noexcept {
+        std::printf ( " Session, compaction\n" );
+        session<State, mcts::ContiguousChildren> ( "off", iterations_, budget_, 0 );
+        session<State, mcts::ContiguousChildren> ( "on", iterations_, budget_, 16 );
+    }
+
+
+    // The playing strength of the Statistics against NodeStatistics, at equal
+    // iterations_ per move, over no_matches_ matches, the Statistics play the
+    // agent in the even and the human in the odd matches. Reports the wins,
+    // draws and losses of the Statistics.
+
+    template<typename State, typename Layout, typename Statistics>
+    void strength ( const char * name_, const index_t iterations_, const index_t no_matches_ ) noexcept {
+        using Arcs = mcts::Mcts<State, Layout, Statistics>;
+        using Nodes = mcts::Mcts<State, Layout, mcts::NodeStatistics>;
+        using Player = typename Nodes::Player;
+        seed ( 1234u );
+        std::uint32_t wins = 0u, draws = 0u;
+        const Clock::time_point start = Clock::now ( );
+        for ( index_t m = 0; m < no_matches_; ++m ) {
+            const Player arcs_player = 0 == m % 2 ? Player::Type::agent : Player::Type::human;
+            State state;
+            state.initialize ( );
+            Arcs * arcs = new Arcs ( );
+            Nodes * nodes = new Nodes ( );
+            arcs->seed ( 5678u + m );
+            nodes->seed ( 91011u + m );
+            std::optional<Player> winner;
+            do {
+                state.move_hash_winner ( state.playerToMove ( ) == arcs_player ? arcs->compute ( state, iterations_ ) : nodes->compute ( state, iterations_ ) );
+                if ( state.playerToMove ( ) == arcs_player ) {
+                    Arcs::prune ( arcs, state );
+                }
+                else {
+                    Nodes::prune ( nodes, state );
+                }
+            } while ( not ( winner = state.ended ( ) ) );
+            wins += * winner == arcs_player;
+            draws += winner->vacant ( );
+            delete nodes;
+            delete arcs;
+        }
+        const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        std::printf ( " %s: %u wins, %u draws, %u losses (%.1f%% score, %.1f s)\n", name_, wins, draws, no_matches_ - wins - draws, 100.0f * ( wins + 0.5f * draws ) / no_matches_, seconds );
+    }
+
+    template<typename State>
+    void statistics ( const index_t iterations_ = 20'000, const index_t no_matches_ = 200 ) noexcept {
+        std::printf ( " Strength, arc statistics against node statistics\n" );
+        strength<State, mcts::ArrayOfStructs, mcts::ArcUCT3> ( "uct3", iterations_, no_matches_ );
+        strength<State, mcts::ArrayOfStructs, mcts::ArcMax> ( "max", iterations_, no_matches_ );
+    }
+
+
+    // The random playouts per second of State, from the initial position.
+
+    template<typename State>
+    void playouts ( const char * name_, const index_t no_playouts_ = 2'000'000 ) noexcept {
+        rng_t rng ( 1234u );
+        State state;
+        state.initialize ( );
+        float score = 0.0f;
+        const Clock::time_point start = Clock::now ( );
+        for ( index_t i = 0; i < no_playouts_; ++i ) {
+            State playout ( state );
+            playout.simulate ( rng );
+            score += playout.result ( state.playerToMove ( ) );
+        }
+        const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        std::printf ( " %s: %.0f playouts/s (%.3f mean result of the first player)\n", name_, no_playouts_ / seconds, score / no_playouts_ );
+    }
+
+    // As playouts, State::batch_size playouts per (batch) simulate.
+
+    template<typename State>
+    void batchPlayouts ( const char * name_, const index_t no_playouts_ = 2'000'000 ) noexcept {
+        using Player = typename State::Player;
+        rng_t rng ( 1234u );
+        State state;
+        state.initialize ( );
+        float score = 0.0f;
+        Player winners [ State::batch_size ];
+        const Clock::time_point start = Clock::now ( );
+        for ( index_t i = 0; i < no_playouts_; i += ( index_t ) State::batch_size ) {
+            state.simulate ( rng, winners );
+            for ( const Player winner : winners ) {
+                score += winner.vacant ( ) ? 0.0f : ( winner == state.playerToMove ( ) ? 1.0f : -1.0f );
+            }
+        }
+        const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        std::printf ( " %s: %.0f playouts/s (%.3f mean result of the first player)\n", name_, no_playouts_ / seconds, score / no_playouts_ );
+    }
+
+    // Self-play of no_matches_ matches (iterations_ per move for both sides), the
+    // engines share a position_cache_ (if not nullptr) with each other and with
+    // the engines of the other matches. Reports the time, the score of the
+    // agent and the hit rate of the cache.
+
+    template<typename State>
+    void selfPlay ( const char * name_, const index_t iterations_, const index_t no_matches_, pc::PositionCache * position_cache_ ) noexcept {
+        using Mcts = mcts::Mcts<State>;
+        using Player = typename Mcts::Player;
+        seed ( 1234u );
+        std::uint32_t wins = 0u, draws = 0u;
+        std::uint64_t hits = 0u, lookups = 0u;
+        const Clock::time_point start = Clock::now ( );
+        for ( index_t m = 0; m < no_matches_; ++m ) {
+            State state;
+            state.initialize ( );
+            Mcts * agent = new Mcts ( ), * human = new Mcts ( );
+            agent->seed ( 5678u + m );
+            human->seed ( 91011u + m );
+            agent->setPositionCache ( position_cache_ );
+            human->setPositionCache ( position_cache_ );
+            std::optional<Player> winner;
+            do {
+                state.move_hash_winner ( state.playerToMove ( ) == Player::Type::agent ? agent->compute ( state, iterations_ ) : human->compute ( state, iterations_ ) );
+                Mcts::prune ( state.playerToMove ( ) == Player::Type::agent ? agent : human, state );
+            } while ( not ( winner = state.ended ( ) ) );
+            wins += winner->agent ( );
+            draws += winner->vacant ( );
+            delete human;
+            delete agent;
+        }
+        const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        if ( nullptr != position_cache_ ) {
+            const pc::PositionCache::Counters counters = position_cache_->counters ( );
+            hits = counters.hits;
+            lookups = counters.hits + counters.misses;
+        }
+        std::printf ( " %s: %.1f%% agent score, %.3f s/match, %.1f%% hits (%llu lookups)\n", name_, 100.0f * ( wins + 0.5f * draws ) / no_matches_, seconds / no_matches_, lookups ? 100.0f * hits / lookups : 0.0f, ( unsigned long long ) lookups );
+    }
+
+    template<typename State>
+    void positionCache ( const index_t iterations_ = 20'000, const index_t no_matches_ = 100 ) noexcept {
+        std::printf ( " Self-play, with and without a shared position cache\n" );
+        selfPlay<State> ( "no cache", iterations_, no_matches_, nullptr );
+        pc::PositionCache * position_cache = new pc::PositionCache ( );
+        selfPlay<State> ( "cache", iterations_, no_matches_, position_cache );
+        delete position_cache;
+    }
+
+
+    // A tree of no_nodes_ nodes, grown by random descents (adding a node per
+    // descent, as a search does) from a pool on PageSize pages. Thereafter the
+    // tree is pruned to a grandchild of the root (a move and the reply) and the
+    // pages holding free nodes only are released.
+
+    template<std::size_t PageSize>
+    void treeBuild ( const char * name_, const std::size_t no_nodes_ ) noexcept {
+        struct Node { // 64 bytes.
+            Node * children [ 7 ] = { };
+            std::int32_t visits = 0;
+            float score = 0.0f;
+        };
+        using Pool = pa::pool_allocator<Node, 1, PageSize>;
+        Pool * pool = new Pool ( );
+        rng_t rng ( 1234u );
+        Node * const root = pool->new_element ( );
+        Clock::time_point start = Clock::now ( );
+        for ( std::size_t i = 1u; i < no_nodes_; ++i ) {
+            Node * node = root;
+            while ( true ) {
+                ++node->visits;
+                Node * & child = node->children [ rng ( ) % 7u ];
+                if ( nullptr == child ) {
+                    child = pool->new_element ( );
+                    break;
+                }
+                node = child;
+            }
+        }
+        const float build = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        const std::size_t mapped = pool->memory_size ( );
+        std::vector<Node *> stack ( std::begin ( root->children ) + 1, std::end ( root->children ) );
+        stack.insert ( std::end ( stack ), std::begin ( root->children [ 0 ]->children ) + 1, std::end ( root->children [ 0 ]->children ) );
+        while ( stack.size ( ) ) {
+            Node * const node = stack.back ( ); stack.pop_back ( );
+            if ( nullptr != node ) {
+                stack.insert ( std::end ( stack ), std::begin ( node->children ), std::end ( node->children ) );
+                pool->delete_element ( node );
+            }
+        }
+        start = Clock::now ( );
+        const std::size_t released = pool->release_free_pages ( );
+        const float prune = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        std::printf ( " %s: %zu nodes, %.1f ns/node, %.1f MB mapped, pruned, released %.1f MB in %.1f ms\n", name_, no_nodes_, 1e9f * build / no_nodes_, mapped / 1'048'576.0f, released / 1'048'576.0f, 1e3f * prune );
+        delete pool;
+    }
+
+    inline void pageSizes ( const std::size_t no_nodes_ = 4'000'000 ) noexcept {
+        std::printf ( " Tree build, pool page sizes\n" );
+        treeBuild<pa::page_size> ( "4K pages", no_nodes_ );
+        treeBuild<pa::huge_page_size> ( "2M pages", no_nodes_ );
+    }
+
+
+    // The UCT selection kernel against the per child evaluation it replaced
+    // (a logf, a sqrtf and two divisions per child, and the same collection of
+    // the ties), over no_children_ children.
+
+    inline void uctKernel ( const std::size_t no_children_, const index_t no_selections_ = 10'000'000 ) noexcept {
+        rng_t rng ( 1234u );
+        alignas ( 32 ) std::int32_t visits [ 512 ];
+        alignas ( 32 ) float scores [ 512 ];
+        std::int32_t parent_visits = 0;
+        for ( std::size_t i = 0u; i < uct::padded ( no_children_ ); ++i ) {
+            visits [ i ] = 1 + ( std::int32_t ) ( rng ( ) % 1'000u );
+            scores [ i ] = ( float ) ( ( std::int64_t ) ( rng ( ) % 2'001u ) - 1'000 ) / 1'000.0f * visits [ i ];
+            parent_visits += visits [ i ];
+        }
+        std::size_t sum = 0u;
+        Clock::time_point start = Clock::now ( );
+        for ( index_t s = 0; s < no_selections_; ++s ) {
+            sum += uct::selectPerChild ( visits, scores, no_children_, parent_visits + ( s & 1 ), rng ); // Defeats hoisting out of the loop.
+        }
+        const float scalar = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        start = Clock::now ( );
+        for ( index_t s = 0; s < no_selections_; ++s ) {
+            sum += uct::select ( visits, scores, no_children_, parent_visits + ( s & 1 ), rng );
+        }
+        const float kernel = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+        std::printf ( " UCT selection, %zu children: per child %.1f ns, kernel %.1f ns (%.1fx) [%zu]\n", no_children_, 1e9f * scalar / no_selections_, 1e9f * kernel / no_selections_, scalar / kernel, sum );
+    }
+}
@@ -0,0 +1,542 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+
+
+namespace bt {
+
+    struct NodeID {
+
+        std::int32_t value = -1;
+
+        static const NodeID invalid;
+
+        [[ nodiscard ]] bool operator == ( const NodeID rhs_ ) const noexcept { return value == rhs_.value; }
+        [[ nodiscard ]] bool operator != ( const NodeID rhs_ ) const noexcept { return value != rhs_.value; }
+
+        template < class Archive >
+        void serialize ( Archive & ar_ ) { ar_ ( value ); }
+    };
+
+    inline constexpr NodeID NodeID::invalid { -1 };
+
+    struct ArcID {
+
+        std::int32_t value = -1;
+
+        static const ArcID invalid;
+
+        [[ nodiscard ]] bool operator == ( const ArcID rhs_ ) const noexcept { return value == rhs_.value; }
+        [[ nodiscard ]] bool operator != ( const ArcID rhs_ ) const noexcept { return value != rhs_.value; }
+
+        template < class Archive >
+        void serialize ( Archive & ar_ ) { ar_ ( value ); }
+    };
+
+    inline constexpr ArcID ArcID::invalid { -1 };
+
+    struct Link {
+
+        ArcID arc;
+        NodeID target;
+
+        Link ( ) noexcept { }
+        Link ( const ArcID arc_, const NodeID target_ ) noexcept : arc ( arc_ ), target ( target_ ) { }
+    };
+
+    // The path from the root, as in fst::SearchTree.
+
+    class Path {
+
+        std::vector<Link> m_links;
+
+    public:
+
+        void reset ( const ArcID arc_, const NodeID node_ ) {
+            m_links.clear ( );
+            m_links.emplace_back ( arc_, node_ );
+        }
+
+        void push ( const Link & link_ ) {
+            m_links.push_back ( link_ );
+        }
+
+        void push ( const ArcID arc_, const NodeID node_ ) {
+            m_links.emplace_back ( arc_, node_ );
+        }
+
+        void resize ( const std::size_t size_ ) {
+            m_links.resize ( size_ );
+        }
+
+        [[ nodiscard ]] std::size_t size ( ) const noexcept {
+            return m_links.size ( );
+        }
+
+        [[ nodiscard ]] Link & back ( ) noexcept {
+            return m_links.back ( );
+        }
+
+        [[ nodiscard ]] const Link & back ( ) const noexcept {
+            return m_links.back ( );
+        }
+
+        [[ nodiscard ]] auto begin ( ) noexcept { return m_links.begin ( ); }
+        [[ nodiscard ]] auto end ( ) noexcept { return m_links.end ( ); }
+        [[ nodiscard ]] auto begin ( ) const noexcept { return m_links.cbegin ( ); }
+        [[ nodiscard ]] auto end ( ) const noexcept { return m_links.cend ( ); }
+    };
+
+
+    // A search tree (a rooted dag, with transpositions) storing the out-arcs of
+    // each node as one contiguous block of Capacity (arc data, child) entries,
+    // allocated when the first arc out of the node is added. An ArcID is the
+    // index of its entry, iterating the children of a node is a linear scan
+    // over its block, instead of a pointer chase over a linked list of arcs.
+    //
+    // The interface is the part of fst::SearchTree used by Mcts, the in-arcs
+    // are counted, not stored, i.e. there is no in-iteration.
+    //
+    // Nodes and blocks can be released (see Mcts::evict ( )), their slots go
+    // to free lists and are reused by later insertions, the vectors don't
+    // shrink.
+
+    template<typename ArcData, typename NodeData, std::size_t Capacity>
+    class BlockTree {
+
+    public:
+
+        using NodeID = bt::NodeID;
+        using ArcID = bt::ArcID;
+        using Link = bt::Link;
+        using Path = bt::Path;
+
+        using Visited = std::vector<NodeID>;
+        using Stack = std::vector<NodeID>;
+
+        struct Entry {
+            ArcData data;
+            NodeID target;
+        };
+
+        struct Node {
+            NodeData data;
+            std::int32_t block = -1;
+            std::uint16_t no_out = 0, no_in = 0; // The in-degree saturates, a saturated node is never released.
+        };
+
+        static_assert ( Capacity <= UINT16_MAX, "the out-degree is 16 bits" );
+
+    private:
+
+        std::vector<Node> m_nodes;
+        std::vector<Entry> m_entries; // The blocks, Capacity entries each.
+        std::vector<NodeID> m_free_nodes;
+        std::vector<std::int32_t> m_free_blocks;
+        std::vector<NodeID> m_vacated_nodes; // Held back during a compaction.
+        std::vector<std::int32_t> m_vacated_blocks;
+
+    public:
+
+        NodeID root_node { 0 };
+        ArcID root_arc = ArcID::invalid;
+
+        class OutIt {
+
+            const BlockTree * m_tree;
+            std::int32_t m_index, m_end;
+
+        public:
+
+            OutIt ( const BlockTree & tree_, const NodeID node_ ) noexcept :
+                m_tree ( & tree_ ),
+                m_index ( tree_.m_nodes [ node_.value ].block ),
+                m_end ( m_index + tree_.m_nodes [ node_.value ].no_out ) {
+            }
+
+            [[ nodiscard ]] bool is_valid ( ) const noexcept {
+                return m_index < m_end;
+            }
+
+            [[ maybe_unused ]] OutIt & operator ++ ( ) noexcept {
+                ++m_index;
+                return * this;
+            }
+
+            [[ nodiscard ]] ArcID id ( ) const noexcept {
+                return ArcID { m_index };
+            }
+
+            [[ nodiscard ]] ArcID get ( ) const noexcept {
+                return ArcID { m_index };
+            }
+
+            [[ nodiscard ]] const Entry * operator -> ( ) const noexcept {
+                return m_tree->m_entries.data ( ) + m_index;
+            }
+
+            [[ nodiscard ]] bool operator != ( const ArcID ) const noexcept {
+                return is_valid ( );
+            }
+
+            [[ nodiscard ]] static ArcID end ( ) noexcept {
+                return ArcID::invalid;
+            }
+        };
+
+        class InIt; // Not supported.
+
+        using out_iterator = OutIt;
+        using const_out_iterator = OutIt;
+        using in_iterator = InIt;
+        using const_in_iterator = InIt;
+
+        BlockTree ( ) {
+            m_nodes.emplace_back ( );
+        }
+
+        // Nodes.
+
+        template<typename ... Args, typename = std::enable_if_t<not ( sizeof ... ( Args ) == 1 and ( std::is_same_v<std::decay_t<Args>, NodeID> and ... ) )>>
+        [[ maybe_unused ]] NodeID addNode ( Args && ... args_ ) {
+            if ( m_free_nodes.size ( ) ) {
+                const NodeID node = m_free_nodes.back ( );
+                m_free_nodes.pop_back ( );
+                m_nodes [ node.value ] = Node { NodeData ( std::forward<Args> ( args_ ) ... ) };
+                return node;
+            }
+            m_nodes.push_back ( Node { NodeData ( std::forward<Args> ( args_ ) ... ) } );
+            return NodeID { ( std::int32_t ) m_nodes.size ( ) - 1 };
+        }
+
+        // Adds a new child (with default data) of parent_.
+
+        [[ maybe_unused ]] Link addNode ( const NodeID parent_ ) {
+            const NodeID child = addNode ( );
+            return addArc ( parent_, child );
+        }
+
+        // Arcs.
+
+        template<typename Data, typename ... Args>
+        [[ maybe_unused ]] ArcID addArc ( const NodeID parent_, const NodeID child_, Data && data_, Args && ... args_ ) {
+            const ArcID arc = newEntry ( parent_, child_ );
+            m_entries [ arc.value ].data = ArcData ( std::forward<Data> ( data_ ), std::forward<Args> ( args_ ) ... );
+            return arc;
+        }
+
+        [[ maybe_unused ]] Link addArc ( const NodeID parent_, const NodeID child_ ) {
+            return Link { newEntry ( parent_, child_ ), child_ };
+        }
+
+        // Access.
+
+        [[ nodiscard ]] const NodeData & operator [ ] ( const NodeID node_ ) const noexcept { return m_nodes [ node_.value ].data; }
+        [[ nodiscard ]] NodeData & operator [ ] ( const NodeID node_ ) noexcept { return m_nodes [ node_.value ].data; }
+
+        [[ nodiscard ]] const ArcData & operator [ ] ( const ArcID arc_ ) const noexcept { return m_entries [ arc_.value ].data; }
+        [[ nodiscard ]] ArcData & operator [ ] ( const ArcID arc_ ) noexcept { return m_entries [ arc_.value ].data; }
+
+        [[ nodiscard ]] const ArcData & operator [ ] ( const OutIt & it_ ) const noexcept { return m_entries [ it_.id ( ).value ].data; }
+        [[ nodiscard ]] ArcData & operator [ ] ( const OutIt & it_ ) noexcept { return m_entries [ it_.id ( ).value ].data; }
+
+        [[ nodiscard ]] Link link ( const ArcID arc_ ) const noexcept {
+            return Link { arc_, m_entries [ arc_.value ].target };
+        }
+
+        [[ nodiscard ]] Link link ( const OutIt & it_ ) const noexcept {
+            return link ( it_.id ( ) );
+        }
+
+        // The arc from parent_ to child_, ArcID::invalid if there is none.
+
+        [[ nodiscard ]] Link link ( const NodeID parent_, const NodeID child_ ) const noexcept {
+            for ( OutIt a { * this, parent_ }; a.is_valid ( ); ++a ) {
+                if ( child_ == a->target ) {
+                    return Link { a.id ( ), child_ };
+                }
+            }
+            return Link { ArcID::invalid, child_ };
+        }
+
+        [[ nodiscard ]] OutIt cbeginOut ( const NodeID node_ ) const noexcept {
+            return OutIt { * this, node_ };
+        }
+
+        [[ nodiscard ]] std::int32_t outArcNum ( const NodeID node_ ) const noexcept {
+            return m_nodes [ node_.value ].no_out;
+        }
+
+        [[ nodiscard ]] std::int32_t inArcNum ( const NodeID node_ ) const noexcept {
+            return m_nodes [ node_.value ].no_in;
+        }
+
+        [[ nodiscard ]] bool isInternal ( const NodeID node_ ) const noexcept {
+            return m_nodes [ node_.value ].no_out > 0;
+        }
+
+        [[ nodiscard ]] bool isLeaf ( const NodeID node_ ) const noexcept {
+            return not ( isInternal ( node_ ) );
+        }
+
+        // The number of nodes in the tree, nodesSize ( ) includes the released
+        // slots, i.e. is one past the largest NodeID.
+
+        [[ nodiscard ]] std::size_t nodeNum ( ) const noexcept {
+            return m_nodes.size ( ) - m_free_nodes.size ( ) - m_vacated_nodes.size ( );
+        }
+
+        [[ nodiscard ]] std::size_t nodesSize ( ) const noexcept {
+            return m_nodes.size ( );
+        }
+
+        [[ nodiscard ]] std::size_t arcNum ( ) const noexcept {
+            std::size_t no_arcs = 0u;
+            for ( const Node & node : m_nodes ) {
+                no_arcs += node.no_out;
+            }
+            return no_arcs;
+        }
+
+        [[ nodiscard ]] std::size_t memory ( ) const noexcept {
+            return m_nodes.capacity ( ) * sizeof ( Node ) + m_entries.capacity ( ) * sizeof ( Entry );
+        }
+
+        // The bytes held by the nodes and blocks in use, excluding the free slots.
+
+        [[ nodiscard ]] std::size_t liveMemory ( ) const noexcept {
+            return nodeNum ( ) * sizeof ( Node ) + ( m_entries.size ( ) - ( m_free_blocks.size ( ) + m_vacated_blocks.size ( ) ) * Capacity ) * sizeof ( Entry );
+        }
+
+        [[ nodiscard ]] static constexpr std::size_t nodeMemory ( ) noexcept {
+            return sizeof ( Node );
+        }
+
+        [[ nodiscard ]] static constexpr std::size_t blockMemory ( ) noexcept {
+            return Capacity * sizeof ( Entry );
+        }
+
+        // Release.
+
+        // Removes all arcs out of node_ (the node becomes a leaf), the block goes
+        // to the free list. The children are not touched, see releaseIn ( ).
+
+        void clearOut ( const NodeID node_ ) noexcept {
+            Node & node = m_nodes [ node_.value ];
+            if ( -1 != node.block ) {
+                m_free_blocks.push_back ( node.block );
+                node.block = -1;
+                node.no_out = 0;
+            }
+        }
+
+        // Removes one in-arc of node_ from the count, returns true if that was
+        // the last one, i.e. node_ is unreachable and can be released.
+
+        [[ nodiscard ]] bool releaseIn ( const NodeID node_ ) noexcept {
+            std::uint16_t & no_in = m_nodes [ node_.value ].no_in;
+            if ( UINT16_MAX == no_in ) {
+                return false;
+            }
+            return 0 == --no_in;
+        }
+
+        // Releases node_, which must have no arcs out (anymore), its data is
+        // reset (destroyed) and the slot goes to the free list.
+
+        void releaseNode ( const NodeID node_ ) noexcept {
+            assert ( -1 == m_nodes [ node_.value ].block );
+            m_nodes [ node_.value ] = Node { };
+            m_free_nodes.push_back ( node_ );
+        }
+
+        // Compaction.
+
+        // The free lists are sorted, such that the lowest free slots are taken
+        // first (by addNode ( ... ) as well), the slots vacated by relocate ( ... )
+        // and relocateBlock ( ... ) are held back until endCompaction ( ).
+
+        void beginCompaction ( ) {
+            std::sort ( std::begin ( m_free_nodes ), std::end ( m_free_nodes ), [ ] ( const NodeID a_, const NodeID b_ ) { return a_.value > b_.value; } );
+            std::sort ( std::begin ( m_free_blocks ), std::end ( m_free_blocks ), std::greater<std::int32_t> ( ) );
+        }
+
+        // Moves the target of arc_, if arc_ is its only in-arc, into the lowest
+        // free slot, if that is below it. Returns the (new) NodeID of the target.
+
+        [[ nodiscard ]] NodeID relocate ( const ArcID arc_ ) noexcept {
+            NodeID & target = m_entries [ arc_.value ].target;
+            if ( 1 != m_nodes [ target.value ].no_in or m_free_nodes.empty ( ) or m_free_nodes.back ( ).value > target.value ) {
+                return target;
+            }
+            const NodeID slot = m_free_nodes.back ( );
+            m_free_nodes.pop_back ( );
+            m_nodes [ slot.value ] = std::move ( m_nodes [ target.value ] );
+            m_nodes [ target.value ] = Node { };
+            m_vacated_nodes.push_back ( target );
+            target = slot;
+            return slot;
+        }
+
+        // Moves the root_node (which has no in-arc) into the lowest free slot, if
+        // that is below it. Returns the (new) root_node.
+
+        [[ maybe_unused ]] NodeID relocateRoot ( ) noexcept {
+            if ( m_free_nodes.empty ( ) or m_free_nodes.back ( ).value > root_node.value ) {
+                return root_node;
+            }
+            const NodeID slot = m_free_nodes.back ( );
+            m_free_nodes.pop_back ( );
+            m_nodes [ slot.value ] = std::move ( m_nodes [ root_node.value ] );
+            m_nodes [ root_node.value ] = Node { };
+            m_vacated_nodes.push_back ( root_node );
+            root_node = slot;
+            return slot;
+        }
+
+        // Moves the block of node_ into the lowest free block, if that is below it.
+
+        void relocateBlock ( const NodeID node_ ) noexcept {
+            Node & node = m_nodes [ node_.value ];
+            if ( -1 == node.block or m_free_blocks.empty ( ) or m_free_blocks.back ( ) > node.block ) {
+                return;
+            }
+            const std::int32_t block = m_free_blocks.back ( );
+            m_free_blocks.pop_back ( );
+            std::move ( std::begin ( m_entries ) + node.block, std::begin ( m_entries ) + node.block + node.no_out, std::begin ( m_entries ) + block );
+            m_vacated_blocks.push_back ( node.block );
+            node.block = block;
+        }
+
+        // Returns the vacated slots to the free lists and trims the free slots
+        // off the ends of the nodes and the blocks.
+
+        void endCompaction ( ) {
+            m_free_nodes.insert ( std::end ( m_free_nodes ), std::begin ( m_vacated_nodes ), std::end ( m_vacated_nodes ) );
+            m_free_blocks.insert ( std::end ( m_free_blocks ), std::begin ( m_vacated_blocks ), std::end ( m_vacated_blocks ) );
+            m_vacated_nodes.clear ( );
+            m_vacated_blocks.clear ( );
+            beginCompaction ( );
+            std::size_t no_nodes = 0u, no_blocks = 0u;
+            while ( no_nodes < m_free_nodes.size ( ) and m_free_nodes [ no_nodes ].value == ( std::int32_t ) ( m_nodes.size ( ) - no_nodes - 1u ) ) {
+                ++no_nodes;
+            }
+            while ( no_blocks < m_free_blocks.size ( ) and m_free_blocks [ no_blocks ] == ( std::int32_t ) ( m_entries.size ( ) - ( no_blocks + 1u ) * Capacity ) ) {
+                ++no_blocks;
+            }
+            m_free_nodes.erase ( std::begin ( m_free_nodes ), std::begin ( m_free_nodes ) + no_nodes );
+            m_free_blocks.erase ( std::begin ( m_free_blocks ), std::begin ( m_free_blocks ) + no_blocks );
+            m_nodes.resize ( m_nodes.size ( ) - no_nodes );
+            m_entries.resize ( m_entries.size ( ) - no_blocks * Capacity );
+        }
+
+        void reserve ( const std::size_t no_nodes_ ) {
+            m_nodes.reserve ( no_nodes_ );
+            m_entries.reserve ( no_nodes_ * Capacity / 2u );
+        }
+
+        // Removes all nodes, including the root.
+
+        void clearUnsafe ( ) noexcept {
+            m_nodes.clear ( );
+            m_entries.clear ( );
+            m_free_nodes.clear ( );
+            m_free_blocks.clear ( );
+            m_vacated_nodes.clear ( );
+            m_vacated_blocks.clear ( );
+        }
+
+    private:
+
+        [[ nodiscard ]] ArcID newEntry ( const NodeID parent_, const NodeID child_ ) {
+            Node & parent = m_nodes [ parent_.value ];
+            if ( -1 == parent.block ) { // First expansion, allocate the block.
+                if ( m_free_blocks.size ( ) ) {
+                    parent.block = m_free_blocks.back ( );
+                    m_free_blocks.pop_back ( );
+                }
+                else {
+                    parent.block = ( std::int32_t ) m_entries.size ( );
+                    m_entries.resize ( m_entries.size ( ) + Capacity );
+                }
+            }
+            assert ( parent.no_out < Capacity );
+            const ArcID arc { parent.block + parent.no_out };
+            ++parent.no_out;
+            m_entries [ arc.value ].target = child_;
+            std::uint16_t & no_in = m_nodes [ child_.value ].no_in;
+            no_in += UINT16_MAX != no_in;
+            return arc;
+        }
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void save ( Archive & ar_ ) const {
+            ar_ ( ( std::uint64_t ) m_nodes.size ( ), ( std::uint64_t ) m_entries.size ( ), root_node );
+            for ( const Node & node : m_nodes ) {
+                ar_ ( node.data, node.block, node.no_out, node.no_in );
+            }
+            for ( const Entry & entry : m_entries ) {
+                ar_ ( entry.data, entry.target );
+            }
+            // The slots held back by a running compaction are free.
+            std::vector<NodeID> free_nodes ( m_free_nodes );
+            std::vector<std::int32_t> free_blocks ( m_free_blocks );
+            free_nodes.insert ( std::end ( free_nodes ), std::begin ( m_vacated_nodes ), std::end ( m_vacated_nodes ) );
+            free_blocks.insert ( std::end ( free_blocks ), std::begin ( m_vacated_blocks ), std::end ( m_vacated_blocks ) );
+            ar_ ( free_nodes, free_blocks );
+        }
+
+        template < class Archive >
+        void load ( Archive & ar_ ) {
+            std::uint64_t no_nodes = 0u, no_entries = 0u;
+            ar_ ( no_nodes, no_entries, root_node );
+            m_nodes.resize ( no_nodes );
+            m_entries.resize ( no_entries );
+            for ( Node & node : m_nodes ) {
+                ar_ ( node.data, node.block, node.no_out, node.no_in );
+            }
+            for ( Entry & entry : m_entries ) {
+                ar_ ( entry.data, entry.target );
+            }
+            ar_ ( m_free_nodes, m_free_blocks );
+        }
+    };
+}
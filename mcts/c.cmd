@@ -1 +1 @@
-clang-cl -DNOMINMAX=1 -DBOOST_USE_WINDOWS_H -DSFML_STATIC -DCEREAL_HAS_NOEXCEPT -DCEREAL_NOEXCEPT=noexcept -DWIN32_LEAN_AND_MEAN=1 -DVC_EXTRALEAN -Xclang -O3 -fuse-ld=lld -flto=thin -Xclang -fcxx-exceptions -Xclang -std=c++2a -Qunused-arguments -Xclang -ffast-math -Xclang -Wno-deprecated-declarations -Xclang -Wno-unknown-pragmas -Xclang -Wno-ignored-pragmas -Xclang -Wno-unused-private-field  -mmmx  -msse  -msse2 -msse3 -mssse3 -msse4.1 -msse4.2 -mavx -mavx2  -Xclang -Wno-unused-variable -Xclang -Wno-language-extension-token -Xclang -Wno-inconsistent-dllimport -Xclang -Wno-nonportable-include-path -I"z:\vc\x64\include" -Ox -MT connect_four.cpp globals.cpp main.cpp -link /LIBPATH:"z:\vc\x64\lib" "integer_utils-s.lib" "sfml-main.lib" "sfml-window-s.lib" "sfml-system-s.lib" "sfml-graphics-s.lib" "freetype-s.lib" "jpeg-s.lib" "sfml-audio-s.lib" "openal-s.lib" "flac-s.lib" "vorbisenc-s.lib" "vorbisfile-s.lib" "vorbis-s.lib" "libboost_random-vc141-mt-s-1_65_1.lib" "libboost_system-vc141-mt-s-1_65_1.lib" "libboost_filesystem-vc141-mt-s-1_65_1.lib" "lz4stream-s.lib" "ogg-s.lib" "gdi32.lib" "opengl32.lib" "winmm.lib" "kernel32.lib" "user32.lib" "winspool.lib" "comdlg32.lib" "advapi32.lib" "shell32.lib" "ole32.lib" "oleaut32.lib" "uuid.lib" "odbc32.lib" "odbccp32.lib"
\ No newline at end of file
+clang-cl -DNOMINMAX=1 -DBOOST_USE_WINDOWS_H -DSFML_STATIC -DCEREAL_HAS_NOEXCEPT -DCEREAL_NOEXCEPT=noexcept -DWIN32_LEAN_AND_MEAN=1 -DVC_EXTRALEAN -Xclang -O3 -fuse-ld=lld -flto=thin -Xclang -fcxx-exceptions -Xclang -std=c++2a -Qunused-arguments -Xclang -ffast-math -Xclang -Wno-deprecated-declarations -Xclang -Wno-unknown-pragmas -Xclang -Wno-ignored-pragmas -Xclang -Wno-unused-private-field  -mmmx  -msse  -msse2 -msse3 -mssse3 -msse4.1 -msse4.2 -mavx -mavx2  -Xclang -Wno-unused-variable -Xclang -Wno-language-extension-token -Xclang -Wno-inconsistent-dllimport -Xclang -Wno-nonportable-include-path -I"z:\vc\x64\include" -Ox -MT connect_four.cpp globals.cpp main.cpp topology.cpp -link /LIBPATH:"z:\vc\x64\lib" "integer_utils-s.lib" "sfml-main.lib" "sfml-window-s.lib" "sfml-system-s.lib" "sfml-graphics-s.lib" "freetype-s.lib" "jpeg-s.lib" "sfml-audio-s.lib" "openal-s.lib" "flac-s.lib" "vorbisenc-s.lib" "vorbisfile-s.lib" "vorbis-s.lib" "libboost_random-vc141-mt-s-1_65_1.lib" "libboost_system-vc141-mt-s-1_65_1.lib" "libboost_filesystem-vc141-mt-s-1_65_1.lib" "lz4stream-s.lib" "ogg-s.lib" "gdi32.lib" "opengl32.lib" "winmm.lib" "kernel32.lib" "user32.lib" "winspool.lib" "comdlg32.lib" "advapi32.lib" "shell32.lib" "ole32.lib" "oleaut32.lib" "uuid.lib" "odbc32.lib" "odbccp32.lib"
\ No newline at end of file
@@ -0,0 +1,508 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include <utility>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+
+#include "Typedefs.hpp"
+#include "Globals.hpp"
+#include "mcts.hpp"
+#include "position_cache.hpp"
+#include "simd_lanes.hpp"
+#include "uct_simd.hpp"
+
+
+// Self-checks of the data structures and of the search, run with --check. A
+// check prints its name and the outcome, and returns true if it passed.
+
+namespace check {
+
+    [[ maybe_unused ]] inline bool report ( const char * name_, const bool passed_ ) noexcept {
+        std::printf ( " %s: %s\n", name_, passed_ ? "passed" : "FAILED" );
+        return passed_;
+    }
+
+
+    // A position cache hit backs up the value of the rollouts that filled the
+    // cache, and the node scores of the Layout take that value unchanged. A
+    // fractional mean, backed up by the (integer) Compact layout, is rounded
+    // without a bias: over many hits the backed up scores sum up to the mean.
+
+    template<typename State, typename Layout>
+    [[ nodiscard ]] bool positionCache ( const char * name_ ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        using NodeData = typename Mcts::NodeData;
+        using Rollouts = mcts::Rollouts;
+        pc::PositionCache * position_cache = new pc::PositionCache ( 1'048'576u );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 1234u );
+        rng_t rng ( 5678u );
+        State state;
+        state.initialize ( );
+        const Player player = state.playerJustMoved ( );
+        bool passed = true;
+        // Filled by a single batch of rollouts, the hit returns it.
+        mcts->setPositionCache ( position_cache, mcts->m_no_rollouts );
+        const Rollouts filled = mcts->simulate ( state, rng ), hit = mcts->simulate ( state, rng );
+        passed = passed and filled.no_rollouts == hit.no_rollouts and filled.score ( player ) == hit.score ( player ) and filled.score ( player.opponent ( ) ) == hit.score ( player.opponent ( ) );
+        NodeData rolled_out { state }, cached { state };
+        rolled_out.add ( filled.score ( player ), filled.no_rollouts );
+        cached.add ( hit.score ( player ), hit.no_rollouts );
+        passed = passed and rolled_out.score ( ) == cached.score ( ) and rolled_out.visits ( ) == cached.visits ( );
+        // Filled by several batches, the mean over m_no_rollouts is fractional.
+        position_cache->clear ( );
+        mcts->setPositionCache ( position_cache, 5 * mcts->m_no_rollouts + 1 );
+        pc::PositionCache::Stats stats;
+        while ( ( stats = position_cache->find ( state.zobrist ( ), player ) ).visits < 5 * mcts->m_no_rollouts + 1 ) {
+            ( void ) mcts->simulate ( state, rng );
+        }
+        const float mean = stats.score * ( float ) mcts->m_no_rollouts / ( float ) stats.visits;
+        constexpr int no_hits = 1'000;
+        NodeData backed_up { state };
+        for ( int i = 0; i < no_hits; ++i ) {
+            const Rollouts rollouts = mcts->simulate ( state, rng );
+            backed_up.add ( rollouts.score ( player ), rollouts.no_rollouts );
+        }
+        passed = passed and std::abs ( backed_up.score ( ) - no_hits * mean ) <= 1.0f and no_hits * mcts->m_no_rollouts == backed_up.visits ( );
+        delete mcts;
+        delete position_cache;
+        return report ( name_, passed );
+    }
+
+    // The Bitboard state against the Matrix state (f.e. BitboardConnectFour and
+    // ConnectFour) on random games: the same moves, zobrist keys, players and
+    // winners. Every other game is played without determining the winner (by
+    // move_hash ( ), as the selection of a search does) until the board is
+    // full, after which a simulate must leave the state as is.
+
+    template<typename Matrix, typename Bitboard>
+    [[ nodiscard ]] bool bitboard ( const char * name_, const index_t no_games_ = 10'000 ) noexcept {
+        rng_t rng ( 1234u );
+        typename Matrix::Moves matrix_moves;
+        typename Bitboard::Moves bitboard_moves;
+        bool passed = true;
+        for ( index_t g = 0; g < no_games_ and passed; ++g ) {
+            const bool winners = 0 == g % 2;
+            Matrix matrix;
+            Bitboard bitboard;
+            seed ( 5678u + g );
+            matrix.initialize ( );
+            seed ( 5678u + g );
+            bitboard.initialize ( );
+            while ( passed ) {
+                const bool matrix_more = matrix.moves ( & matrix_moves ), bitboard_more = bitboard.moves ( & bitboard_moves );
+                passed = matrix_more == bitboard_more and matrix_moves.size ( ) == bitboard_moves.size ( );
+                for ( index_t i = 0; passed and i < matrix_moves.size ( ); ++i ) {
+                    passed = matrix_moves.at ( i ) == bitboard_moves.at ( i );
+                }
+                if ( not ( matrix_more ) or not ( passed ) ) {
+                    break;
+                }
+                const typename Matrix::Move move = matrix_moves.random ( rng );
+                if ( winners ) {
+                    matrix.move_hash_winner ( move );
+                    bitboard.move_hash_winner ( move );
+                }
+                else {
+                    matrix.move_hash ( move );
+                    bitboard.move_hash ( move );
+                }
+                passed = matrix.zobrist ( ) == bitboard.zobrist ( ) and matrix.playerJustMoved ( ) == bitboard.playerJustMoved ( ) and matrix.lastMove ( ) == bitboard.lastMove ( ) and matrix.ended ( ) == bitboard.ended ( );
+            }
+            Bitboard simulated ( bitboard );
+            simulated.simulate ( rng );
+            passed = passed and ( winners or simulated == bitboard );
+        }
+        return report ( name_, passed );
+    }
+
+    // The operations of sl::Lanes (of the backend compiled in, AVX-512, AVX2
+    // or the fallback) against the same operations a lane at a time.
+
+    [[ nodiscard ]] inline bool lanes ( const char * name_, const index_t no_rounds_ = 10'000 ) noexcept {
+        using sl::Lanes;
+        constexpr std::size_t n = sl::lanes;
+        rng_t rng ( 1234u );
+        bool passed = true;
+        const auto equal = [ ] ( const Lanes lanes_, auto && lane_ ) noexcept {
+            std::uint64_t v [ n ];
+            lanes_.store ( v );
+            for ( std::size_t l = 0u; l < n; ++l ) {
+                if ( v [ l ] != lane_ ( l ) ) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        for ( index_t r = 0; r < no_rounds_ and passed; ++r ) {
+            std::uint64_t a [ n ], b [ n ], c [ n ];
+            for ( std::size_t l = 0u; l < n; ++l ) {
+                a [ l ] = rng ( );
+                b [ l ] = 0 == rng ( ) % 4u ? 0u : rng ( ); // Some zero lanes.
+                c [ l ] = rng ( ) % 70u; // Some counts of 64 and up.
+            }
+            const std::uint32_t m = ( std::uint32_t ) ( rng ( ) >> 32 ), k = 1u + ( std::uint32_t ) ( rng ( ) % 63u );
+            const Lanes x = Lanes::load ( a ), y = Lanes::load ( b ), z = Lanes::load ( c );
+            Lanes xorshift = x | Lanes::broadcast ( 1u );
+            xorshift.next ( );
+            std::uint32_t zero_bits = 0u;
+            for ( std::size_t l = 0u; l < n; ++l ) {
+                zero_bits |= std::uint32_t { 0u != b [ l ] } << l;
+            }
+            passed = equal ( x & y, [ & ] ( std::size_t l_ ) { return a [ l_ ] & b [ l_ ]; } ) and
+                     equal ( x | y, [ & ] ( std::size_t l_ ) { return a [ l_ ] | b [ l_ ]; } ) and
+                     equal ( x ^ y, [ & ] ( std::size_t l_ ) { return a [ l_ ] ^ b [ l_ ]; } ) and
+                     equal ( x + y, [ & ] ( std::size_t l_ ) { return a [ l_ ] + b [ l_ ]; } ) and
+                     equal ( andNot ( x, y ), [ & ] ( std::size_t l_ ) { return ~a [ l_ ] & b [ l_ ]; } ) and
+                     equal ( x >> k, [ & ] ( std::size_t l_ ) { return a [ l_ ] >> k; } ) and
+                     equal ( x << k, [ & ] ( std::size_t l_ ) { return a [ l_ ] << k; } ) and
+                     equal ( x << z, [ & ] ( std::size_t l_ ) { return c [ l_ ] < 64u ? a [ l_ ] << c [ l_ ] : std::uint64_t { 0 }; } ) and
+                     equal ( mul32 ( x, m ), [ & ] ( std::size_t l_ ) { return ( std::uint64_t ) ( std::uint32_t ) a [ l_ ] * m; } ) and
+                     equal ( bounded ( x, 7u ), [ & ] ( std::size_t l_ ) { return ( a [ l_ ] >> 32 ) * 7u >> 32; } ) and
+                     equal ( isZero ( y ), [ & ] ( std::size_t l_ ) { return 0u == b [ l_ ] ? ~std::uint64_t { 0 } : std::uint64_t { 0 }; } ) and
+                     equal ( xorshift, [ & ] ( std::size_t l_ ) {
+                         std::uint64_t s = a [ l_ ] | 1u;
+                         s ^= s << 13;
+                         s ^= s >> 7;
+                         return s ^ ( s << 17 );
+                     } ) and
+                     bits ( y ) == zero_bits and
+                     equal ( Lanes::broadcast ( a [ 0 ] ), [ & ] ( std::size_t ) { return a [ 0 ]; } );
+        }
+        return report ( name_, passed );
+    }
+
+
+    // The UCT selection kernel (of the backend compiled in, AVX2 or the fallback)
+    // against the per child evaluation it replaced: given the same rng, both
+    // select the same child, ties included, over 1 to 512 children.
+
+    [[ nodiscard ]] inline bool uctSelect ( const char * name_, const index_t no_rounds_ = 10'000 ) noexcept {
+        rng_t rng ( 1234u );
+        alignas ( 32 ) std::int32_t visits [ 512 ];
+        alignas ( 32 ) float scores [ 512 ];
+        bool passed = true;
+        for ( index_t r = 0; r < no_rounds_ and passed; ++r ) {
+            const std::size_t n = 1u + ( std::size_t ) ( rng ( ) % ( r & 1 ? 512u : 16u ) );
+            std::int32_t parent_visits = 0;
+            for ( std::size_t i = 0u; i < n; ++i ) {
+                if ( i and ( 0 == r % 8 or 0u == rng ( ) % 4u ) ) { // Some ties, all tied in 1 round in 8.
+                    const std::size_t j = 0 == r % 8 ? 0u : ( std::size_t ) ( rng ( ) % i );
+                    visits [ i ] = visits [ j ];
+                    scores [ i ] = scores [ j ];
+                }
+                else {
+                    visits [ i ] = 1 + ( std::int32_t ) ( rng ( ) % 1'000u );
+                    scores [ i ] = ( float ) ( ( std::int64_t ) ( rng ( ) % 2'001u ) - 1'000 ) / 1'000.0f * visits [ i ];
+                }
+                parent_visits += visits [ i ];
+            }
+            for ( std::size_t i = n; i < uct::padded ( n ); ++i ) { // As padded by Mcts::selectChildUCT ( ... ).
+                visits [ i ] = 1;
+                scores [ i ] = 0.0f;
+            }
+            rng_t kernel_rng ( ( std::uint64_t ) r ), per_child_rng ( ( std::uint64_t ) r );
+            passed = uct::select ( visits, scores, n, parent_visits, kernel_rng ) == uct::selectPerChild ( visits, scores, n, parent_visits, per_child_rng );
+        }
+        return report ( name_, passed );
+    }
+
+
+    // The batch simulate of State (a game per lane) against the simulate of a
+    // game at a time, from random positions: every lane ends in a valid
+    // outcome, and the rates of wins, draws and losses agree (within 3%, some
+    // 6 standard deviations of no_games_ games).
+
+    template<typename State>
+    [[ nodiscard ]] bool batchPlayouts ( const char * name_, const index_t no_positions_ = 20, const index_t no_games_ = 16'000 ) noexcept {
+        rng_t rng ( 1234u );
+        typename State::Moves moves;
+        bool passed = true;
+        const auto outcome = [ ] ( const Player winner_ ) noexcept { return winner_.vacant ( ) ? 1 : ( winner_.agent ( ) ? 0 : 2 ); };
+        for ( index_t p = 0; p < no_positions_ and passed; ++p ) {
+            State state;
+            state.initialize ( );
+            for ( index_t m = p; m > 0 and state.moves ( & moves ); --m ) {
+                state.move_hash_winner ( moves.random ( rng ) );
+            }
+            float serial [ 3 ] = { }, batched [ 3 ] = { };
+            for ( index_t g = 0; g < no_games_; ++g ) {
+                State game ( state );
+                game.simulate ( rng );
+                serial [ outcome ( * game.ended ( ) ) ] += 1.0f;
+            }
+            Player winners [ State::batch_size ];
+            for ( index_t g = 0; g < no_games_; g += ( index_t ) State::batch_size ) {
+                state.simulate ( rng, winners );
+                for ( const Player winner : winners ) {
+                    passed = passed and ( winner.vacant ( ) or winner.agent ( ) or winner == Player::Type::human );
+                    batched [ outcome ( winner ) ] += 1.0f;
+                }
+            }
+            for ( int o = 0; o < 3; ++o ) {
+                passed = passed and std::abs ( serial [ o ] - batched [ o ] ) <= 0.03f * no_games_;
+            }
+        }
+        // A full board of which the winner was not determined (see bitboard ( ... )).
+        State state;
+        state.initialize ( );
+        while ( state.moves ( & moves ) ) {
+            state.move_hash ( moves.random ( rng ) );
+        }
+        Player winners [ State::batch_size ];
+        state.simulate ( rng, winners );
+        for ( const Player winner : winners ) {
+            passed = passed and winner == Player::Type::invalid;
+        }
+        return report ( name_, passed );
+    }
+
+    // Assigning the untried moves of the compact node records (a handle into an
+    // indexed pool) releases the element held before, copies the source's, and
+    // leaves none if the source holds none: no pool element leaks.
+
+    template<typename State>
+    [[ nodiscard ]] bool untriedMovesCopies ( const char * name_ ) noexcept {
+        using Moves = mcts::IndexedMoves<State>;
+        State state;
+        state.initialize ( );
+        const std::size_t live = Moves::s_moves_pool.size ( );
+        bool passed = true;
+        {
+            Moves a { state }, b { state }, none;
+            Moves & alias = a;
+            a = b; // Both hold moves.
+            a = alias;
+            passed = passed and live + 2u == Moves::s_moves_pool.size ( );
+            b = none; // The source holds none.
+            passed = passed and live + 1u == Moves::s_moves_pool.size ( ) and not ( b.any ( ) );
+            none = a; // The target holds none.
+            passed = passed and live + 2u == Moves::s_moves_pool.size ( ) and none.any ( );
+            Moves c { a }, d { std::move ( c ) };
+            d = std::move ( b );
+            passed = passed and live + 3u == Moves::s_moves_pool.size ( );
+        }
+        passed = passed and live == Moves::s_moves_pool.size ( );
+        return report ( name_, passed );
+    }
+
+    // The tree of mcts_, of which the root_node is the position state_, and its
+    // transposition table agree: the nodes reached from the root_node are the
+    // nodes of the tree, a node is a single position (over every path to it)
+    // with an arc per move at most, and every entry of the table is the only
+    // one of a node reached, found under the key of its position.
+
+    template<typename Mcts, typename State>
+    [[ nodiscard ]] bool consistent ( const Mcts & mcts_, const State & state_ ) noexcept {
+        using NodeID = typename Mcts::NodeID;
+        using Move = typename State::Move;
+        using ZobristHash = decltype ( state_.zobrist ( ) );
+        const auto & tree = mcts_.m_tree;
+        std::vector<ZobristHash> zobrist ( tree.nodesSize ( ), ZobristHash { 0 } );
+        boost::dynamic_bitset<> reached ( tree.nodesSize ( ) );
+        std::vector<std::pair<NodeID, State>> stack { { tree.root_node, state_ } };
+        zobrist [ tree.root_node.value ] = state_.zobrist ( );
+        reached [ tree.root_node.value ] = true;
+        std::size_t no_reached = 1u;
+        std::vector<Move> moves;
+        bool passed = true;
+        while ( stack.size ( ) and passed ) {
+            const auto [ node, state ] = stack.back ( );
+            stack.pop_back ( );
+            moves.clear ( );
+            for ( typename Mcts::cOutIt a = tree.cbeginOut ( node ); a.is_valid ( ); ++a ) {
+                const Move move = tree [ a ].m_move;
+                passed = passed and std::find ( moves.begin ( ), moves.end ( ), move ) == moves.end ( );
+                moves.push_back ( move );
+                State child ( state );
+                child.move_hash ( move );
+                if ( reached [ a->target.value ] ) {
+                    passed = passed and zobrist [ a->target.value ] == child.zobrist ( );
+                }
+                else {
+                    zobrist [ a->target.value ] = child.zobrist ( );
+                    reached [ a->target.value ] = true;
+                    ++no_reached;
+                    stack.emplace_back ( a->target, std::move ( child ) );
+                }
+            }
+            passed = passed and moves.size ( ) <= ( std::size_t ) State::max_no_moves;
+        }
+        passed = passed and tree.nodeNum ( ) == no_reached;
+        boost::dynamic_bitset<> entered ( tree.nodesSize ( ) );
+        mcts_.m_transposition_table->forEach ( [ & ] ( const ZobristHash, const NodeID node_ ) {
+            if ( ( std::size_t ) node_.value >= tree.nodesSize ( ) ) { // Left behind by the tree.
+                passed = false;
+                return;
+            }
+            passed = passed and reached [ node_.value ] and not ( entered [ node_.value ] ) and node_ == mcts_.getNode ( zobrist [ node_.value ] );
+            entered [ node_.value ] = true;
+        }, mcts_.transpositionValidator ( ) );
+        return passed;
+    }
+
+    // Merging the trees of two searches of a position, of which the tables are of
+    // a different number of buckets (the keys of the one are no keys of the
+    // other), and searching on: the trees stay consistent ( ... ).
+
+    template<typename State, typename Layout>
+    [[ nodiscard ]] bool merge ( const char * name_, const index_t iterations_ = 20'000 ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * target = new Mcts ( ), * source = new Mcts ( );
+        target->seed ( 1u );
+        source->seed ( 2u );
+        source->setTranspositionTable ( 64u * 1'024u );
+        ( void ) target->compute ( state, iterations_ );
+        ( void ) source->compute ( state, iterations_ / 2 );
+        bool passed = consistent ( * target, state ) and consistent ( * source, state );
+        Mcts::merge ( target, source );
+        passed = passed and nullptr == source and consistent ( * target, state );
+        ( void ) target->compute ( state, iterations_ );
+        passed = passed and consistent ( * target, state );
+        delete target;
+        return report ( name_, passed );
+    }
+
+    // A search of iterations_ iterations, of which the tree (f.e. the contiguous
+    // child blocks of a BlockTree) is consistent ( ... ).
+
+    template<typename State, typename Layout>
+    [[ nodiscard ]] bool search ( const char * name_, const index_t iterations_ = 50'000 ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        ( void ) mcts->compute ( state, iterations_ );
+        const bool passed = consistent ( * mcts, state );
+        delete mcts;
+        return report ( name_, passed );
+    }
+
+    // A search under a memory budget of budget_ bytes, in slices of iterations_
+    // iterations: nodes are evicted, the tree is brought down to the budget, and
+    // the tree stays consistent ( ... ) after every slice.
+
+    template<typename State, typename Layout>
+    [[ nodiscard ]] bool eviction ( const char * name_, const std::size_t budget_ = 1'048'576u, const index_t iterations_ = 20'000, const index_t no_slices_ = 5 ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        mcts->setMemoryBudget ( budget_ );
+        bool passed = true;
+        for ( index_t s = 0; s < no_slices_ and passed; ++s ) {
+            ( void ) mcts->compute ( state, iterations_ );
+            passed = not ( mcts->m_search_stats.over_budget ) and consistent ( * mcts, state );
+        }
+        passed = passed and mcts->m_no_evicted_nodes > 0;
+        delete mcts;
+        return report ( name_, passed );
+    }
+
+    // A game of self-play, with iterations_ iterations per move, the tree pruned
+    // after every move, in place (rebased) or copied: the tree stays consistent
+    // ( ... ) after every search and every prune.
+
+    template<typename State, typename Layout, bool InPlace>
+    [[ nodiscard ]] bool prune ( const char * name_, const index_t iterations_ = 5'000 ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        bool passed = true;
+        while ( passed and not ( state.ended ( ) ) ) {
+            const typename State::Move move = mcts->compute ( state, iterations_ );
+            passed = consistent ( * mcts, state );
+            state.move_hash_winner ( move );
+            Mcts::template prune<InPlace> ( mcts, state );
+            passed = passed and ( mcts->m_not_initialized or consistent ( * mcts, state ) );
+        }
+        delete mcts;
+        return report ( name_, passed );
+    }
+
+    // A game of self-play, as in prune ( ... ), under a memory budget of budget_
+    // bytes and with incremental compaction, of slice_ nodes a slice: nodes are
+    // relocated (between the prunes and evictions, a pass may still be running
+    // at the end of a search), the tree stays consistent ( ... ).
+
+    template<typename State, typename Layout>
+    [[ nodiscard ]] bool compaction ( const char * name_, const index_t slice_ = 4, const std::size_t budget_ = 1'048'576u, const index_t iterations_ = 20'000 ) noexcept {
+        using Mcts = mcts::Mcts<State, Layout>;
+        seed ( 1234u );
+        State state;
+        state.initialize ( );
+        Mcts * mcts = new Mcts ( );
+        mcts->seed ( 5678u );
+        mcts->setMemoryBudget ( budget_ );
+        mcts->setCompaction ( slice_ );
+        bool passed = true;
+        while ( passed and not ( state.ended ( ) ) ) {
+            const typename State::Move move = mcts->compute ( state, iterations_ );
+            passed = consistent ( * mcts, state );
+            state.move_hash_winner ( move );
+            Mcts::prune ( mcts, state );
+            passed = passed and ( mcts->m_not_initialized or consistent ( * mcts, state ) );
+        }
+        delete mcts;
+        return report ( name_, passed );
+    }
+
+    template<typename State>
+    [[ nodiscard ]] bool all ( ) noexcept {
+        bool passed = true;
+        passed = positionCache<State, mcts::ArrayOfStructs> ( "position cache, array of structs" ) and passed;
+        passed = positionCache<State, mcts::Compact> ( "position cache, compact" ) and passed;
+        passed = untriedMovesCopies<State> ( "untried moves copies" ) and passed;
+        passed = lanes ( "simd lanes" ) and passed;
+        passed = uctSelect ( "uct selection kernel" ) and passed;
+        passed = search<State, mcts::ContiguousChildren> ( "search, contiguous children" ) and passed;
+        passed = search<State, mcts::Compact> ( "search, compact" ) and passed;
+        passed = eviction<State, mcts::ContiguousChildren> ( "eviction, contiguous children" ) and passed;
+        passed = eviction<State, mcts::Compact> ( "eviction, compact" ) and passed;
+        passed = prune<State, mcts::ContiguousChildren, true> ( "prune, in place" ) and passed;
+        passed = prune<State, mcts::ContiguousChildren, false> ( "prune, copied" ) and passed;
+        passed = compaction<State, mcts::ContiguousChildren> ( "compaction, contiguous children" ) and passed;
+        passed = compaction<State, mcts::Compact> ( "compaction, compact" ) and passed;
+        passed = merge<State, mcts::ContiguousChildren> ( "merge, tables of a different size" ) and passed;
+        return passed;
+    }
+}
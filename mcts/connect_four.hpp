@@ -27,6 +27,7 @@
 #include <array>
 
 #include <optional>
+#include <type_traits>
 
 #include <cereal/cereal.hpp>
 #include <cereal/archives/binary.hpp>
@@ -314,13 +315,13 @@ public:
 	}
 
 
-	void simulate ( ) noexcept {
+	void simulate ( rng_t & rng_ ) noexcept {
 
 		Moves m;
 
 		while ( moves ( & m ) ) {
 
-			move_winner ( m.random ( ) );
+			move_winner ( m.random ( rng_ ) );
 		}
 	}
 
@@ -470,6 +471,17 @@ const typename ConnectFour < NumRows, NumCols >::ZobristHash * ConnectFour < Num
 	m_zobrist_player_key_values + 1
 };
 
+// The moves are the vacant columns, in column order, the untried moves are a bitmask.
+
+namespace mcts {
+
+	template<typename State>
+	struct untried_bitmask;
+
+	template < std::size_t NumRows, std::size_t NumCols >
+	struct untried_bitmask<ConnectFour<NumRows, NumCols>> : std::true_type { };
+}
+
 /* Spare hash keys...
 
 0xe028283c7b3c8bc3ull, 0x0fce58188743146dull, 0x5c0d56eb69eac805ull
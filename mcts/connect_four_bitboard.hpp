@@ -0,0 +1,376 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <utility>
+#include <optional>
+#include <type_traits>
+
+#include <cereal/cereal.hpp>
+
+#include "Globals.hpp"
+#include "Typedefs.hpp"
+#include "player.hpp"
+#include "moves.hpp"
+#include "connect_four.hpp"
+#include "simd_lanes.hpp"
+
+
+// ConnectFour on bitboards, a drop-in for ConnectFour<> (the same moves, in
+// the same order, and the same zobrist keys). The pieces of each player are a
+// mask of a column-major board of NumRows + 1 bits per column, the top bit of
+// every column stays empty (a sentinel), i.e. a shift never carries a line
+// over from one column into the next. A byte per column holds the index of
+// the lowest vacant cell of the column, a move is a single or. A win is four
+// shift-and-ands (one per direction) on the mask of the player that just
+// moved, the vacant cells that can be played are ( all + bottom row ) &
+// board, i.e. the moves come from a mask.
+
+template < std::size_t NumRows = 6, std::size_t NumCols = 7 >
+class BitboardConnectFour {
+
+    static_assert ( ( NumRows + 1 ) * NumCols <= 64, "a board of NumRows + 1 bits per column fits in 64 bits" );
+    static_assert ( NumCols <= 8, "the column heights are a byte per column" );
+
+    using Matrix = ConnectFour<NumRows, NumCols>; // The zobrist keys.
+
+public:
+
+    using Player = ::Player;
+    using ZobristHash = std::uint64_t;
+    using Move = ::Move;
+    using Moves = ::Moves<Move, NumCols>;
+
+    static constexpr index_t max_no_moves = NumCols;
+    static constexpr std::size_t batch_size = sl::lanes; // The games of a batch simulate.
+    static constexpr bool batch_playouts = sl::vectorized; // A batch simulate is faster than batch_size simulates.
+
+private:
+
+    static constexpr std::uint64_t column_height = NumRows + 1; // With the sentinel.
+
+    [[ nodiscard ]] static constexpr std::uint64_t bottomRow ( ) noexcept {
+        std::uint64_t row = 0u;
+        for ( std::size_t col = 0u; col < NumCols; ++col ) {
+            row |= std::uint64_t { 1 } << ( col * column_height );
+        }
+        return row;
+    }
+
+    [[ nodiscard ]] static constexpr std::uint64_t initialHeights ( ) noexcept {
+        std::uint64_t heights = 0u;
+        for ( std::size_t col = 0u; col < NumCols; ++col ) {
+            heights |= ( std::uint64_t ) ( col * column_height ) << ( 8u * col );
+        }
+        return heights;
+    }
+
+    static constexpr std::uint64_t bottom_row = bottomRow ( );
+    static constexpr std::uint64_t column = ( std::uint64_t { 1 } << NumRows ) - 1u; // The cells of column 0.
+    static constexpr std::uint64_t board = bottom_row * column; // The cells, not the sentinels.
+
+    // 8 + 16 + 8 + 1 + 1 + 1 + 1 + 4 = 40 bytes.
+
+    ZobristHash m_zobrist_hash = Matrix::m_zobrist_player_keys [ ( index_t ) Player::Type::vacant ];
+    std::uint64_t m_pieces [ 2 ] = { 0u, 0u }; // By Player::as_01index ( ).
+    std::uint64_t m_heights = initialHeights ( ); // The bit of the lowest vacant cell, a byte per column.
+    std::uint8_t m_no_moves = 0u;
+    Player m_player_just_moved = Player::random ( ), m_winner = Player::Type::invalid;
+    Move m_move = Move::root;
+    std::uint8_t m_padding [ 4 ] = { 0u, 0u, 0u, 0u };
+
+    // Four in a line, per direction: vertical (1), horizontal (column_height)
+    // and the diagonals (column_height - 1 and + 1).
+
+    [[ nodiscard ]] static bool connected ( const std::uint64_t pieces_ ) noexcept {
+        std::uint64_t m = pieces_ & ( pieces_ >> 1 );
+        if ( m & ( m >> 2 ) ) {
+            return true;
+        }
+        m = pieces_ & ( pieces_ >> column_height );
+        if ( m & ( m >> ( 2u * column_height ) ) ) {
+            return true;
+        }
+        m = pieces_ & ( pieces_ >> ( column_height - 1u ) );
+        if ( m & ( m >> ( 2u * ( column_height - 1u ) ) ) ) {
+            return true;
+        }
+        m = pieces_ & ( pieces_ >> ( column_height + 1u ) );
+        return m & ( m >> ( 2u * ( column_height + 1u ) ) );
+    }
+
+    // The lanes in which the pieces hold four in a line are not zero.
+
+    [[ nodiscard ]] static sl::Lanes connected ( const sl::Lanes pieces_ ) noexcept {
+        sl::Lanes m = pieces_ & ( pieces_ >> 1u ), fours = m & ( m >> 2u );
+        m = pieces_ & ( pieces_ >> column_height );
+        fours = fours | ( m & ( m >> ( 2u * column_height ) ) );
+        m = pieces_ & ( pieces_ >> ( column_height - 1u ) );
+        fours = fours | ( m & ( m >> ( 2u * ( column_height - 1u ) ) ) );
+        m = pieces_ & ( pieces_ >> ( column_height + 1u ) );
+        return fours | ( m & ( m >> ( 2u * ( column_height + 1u ) ) ) );
+    }
+
+    [[ nodiscard ]] std::uint64_t vacant ( ) const noexcept {
+        return ( ( m_pieces [ 0 ] | m_pieces [ 1 ] ) + bottom_row ) & board;
+    }
+
+    // Plays col_ (at bit_), returns bit_.
+
+    std::uint32_t play ( const index_t col_, const std::uint32_t bit_ ) noexcept {
+        m_heights += std::uint64_t { 1 } << ( 8u * col_ );
+        m_player_just_moved.next ( );
+        m_pieces [ m_player_just_moved.as_01index ( ) ] |= std::uint64_t { 1 } << bit_;
+        m_move = col_;
+        ++m_no_moves;
+        return bit_;
+    }
+
+public:
+
+    BitboardConnectFour ( ) noexcept { }
+
+    void initialize ( ) noexcept {
+        * this = BitboardConnectFour { };
+    }
+
+    [[ nodiscard ]] bool operator == ( const BitboardConnectFour & rhs_ ) const noexcept {
+        return std::memcmp ( this, & rhs_, sizeof ( BitboardConnectFour ) ) == 0;
+    }
+
+    [[ nodiscard ]] bool operator != ( const BitboardConnectFour & rhs_ ) const noexcept {
+        return std::memcmp ( this, & rhs_, sizeof ( BitboardConnectFour ) ) != 0;
+    }
+
+    [[ nodiscard ]] Player playerJustMoved ( ) const noexcept {
+        return m_player_just_moved;
+    }
+
+    [[ nodiscard ]] Player playerToMove ( ) const noexcept {
+        return m_player_just_moved.opponent ( );
+    }
+
+    [[ nodiscard ]] Move lastMove ( ) const noexcept {
+        return m_move;
+    }
+
+    // Returns the bit of the cell played.
+
+    [[ maybe_unused ]] std::uint32_t move ( const Move move_ ) noexcept {
+        const index_t col = move_.m_loc;
+        return play ( col, ( std::uint32_t ) ( m_heights >> ( 8u * col ) ) & 0xffu );
+    }
+
+    [[ maybe_unused ]] std::uint32_t hash ( const std::uint32_t bit_ ) noexcept {
+        m_zobrist_hash ^= Matrix::m_zobrist_keys.at ( m_player_just_moved.as_01index ( ), ( index_t ) ( NumRows - 1u - bit_ % column_height ), ( index_t ) ( bit_ / column_height ) );
+        return bit_;
+    }
+
+    void winner ( const std::uint32_t ) noexcept {
+        if ( connected ( m_pieces [ m_player_just_moved.as_01index ( ) ] ) ) {
+            m_winner = m_player_just_moved;
+        }
+        else if ( NumRows * NumCols == m_no_moves ) {
+            m_winner = Player::Type::vacant;
+        }
+    }
+
+    void move_hash ( const Move move_ ) noexcept {
+        hash ( move ( move_ ) );
+    }
+
+    void move_hash_winner ( const Move move_ ) noexcept {
+        winner ( hash ( move ( move_ ) ) );
+    }
+
+    void move_winner ( const Move move_ ) noexcept {
+        winner ( move ( move_ ) );
+    }
+
+    [[ nodiscard ]] ZobristHash zobrist ( ) const noexcept {
+        return m_zobrist_hash ^ Matrix::m_zobrist_player_keys [ m_player_just_moved.as_index ( ) ];
+    }
+
+    // The vacant columns, in column order.
+
+    [[ maybe_unused ]] bool moves ( Moves * m_ ) const noexcept {
+        m_->clear ( );
+        if ( NumRows * NumCols == m_no_moves or m_winner != Player::Type::invalid ) {
+            return false;
+        }
+        for ( std::uint64_t vacant = this->vacant ( ); vacant; vacant &= vacant - 1u ) {
+            m_->push_back ( ( index_t ) ( std::countr_zero ( vacant ) / column_height ) );
+        }
+        return true;
+    }
+
+    // Plays random moves until the game ends, a move is a random column (drawn
+    // again if full), no moves list is built. The loop runs on the masks of the
+    // player to move and of the opponent (swapped every move), the other
+    // members are brought up to date at the end. As ConnectFour, a full board
+    // is left as is, also if the winner was not determined (by move_hash ( )).
+
+    void simulate ( rng_t & rng_ ) noexcept {
+        if ( NumRows * NumCols == m_no_moves or m_winner != Player::Type::invalid ) {
+            return;
+        }
+        Player player = m_player_just_moved.opponent ( );
+        std::uint64_t to_move = m_pieces [ player.as_01index ( ) ], just_moved = m_pieces [ m_player_just_moved.as_01index ( ) ], bit;
+        while ( true ) {
+            const std::uint64_t vacant = ( ( to_move | just_moved ) + bottom_row ) & board;
+            do {
+                bit = vacant & column << ( ( ( rng_ ( ) >> 32 ) * NumCols >> 32 ) * column_height );
+            } while ( not ( bit ) );
+            to_move |= bit;
+            ++m_no_moves;
+            if ( connected ( to_move ) ) {
+                m_winner = player;
+                break;
+            }
+            if ( NumRows * NumCols == m_no_moves ) {
+                m_winner = Player::Type::vacant;
+                break;
+            }
+            std::swap ( to_move, just_moved );
+            player.next ( );
+        }
+        m_player_just_moved = player;
+        m_pieces [ player.as_01index ( ) ] = to_move;
+        m_pieces [ player.opponent ( ) == Player::Type::agent ? 0 : 1 ] = just_moved;
+        m_move = ( index_t ) ( std::countr_zero ( bit ) / column_height );
+        // The lowest vacant cell of a column is the lowest bit of ( column +
+        // bottom ), a full column runs into its sentinel.
+        const std::uint64_t all = to_move | just_moved;
+        m_heights = 0u;
+        for ( std::size_t col = 0u; col < NumCols; ++col ) {
+            m_heights |= ( std::uint64_t ) std::countr_zero ( ( all >> ( col * column_height ) ) + 1u ) + col * column_height << ( 8u * col );
+        }
+    }
+
+    // Plays batch_size games from this position at once, a game per lane of
+    // the masks (see simulate ( rng_ )), the state is not changed. The players
+    // move in lock-step, a lane draws (with its own xorshift generator) until
+    // its column is not full and a lane of which the game ended is masked out
+    // of the moves. winners_ [ l ] is the winner of the game in lane l, vacant
+    // for a draw (as simulate ( rng_ ), a full board gives m_winner).
+
+    void simulate ( rng_t & rng_, Player ( & winners_ ) [ batch_size ] ) const noexcept {
+        if ( NumRows * NumCols == m_no_moves or m_winner != Player::Type::invalid ) {
+            std::fill ( std::begin ( winners_ ), std::end ( winners_ ), m_winner );
+            return;
+        }
+        std::uint64_t seeds [ batch_size ];
+        for ( std::uint64_t & seed : seeds ) {
+            seed = rng_ ( ) | 1u; // Xorshift does not leave 0.
+        }
+        sl::Lanes rng = sl::Lanes::load ( seeds );
+        Player player = m_player_just_moved.opponent ( );
+        sl::Lanes to_move = sl::Lanes::broadcast ( m_pieces [ player.as_01index ( ) ] ), just_moved = sl::Lanes::broadcast ( m_pieces [ m_player_just_moved.as_01index ( ) ] );
+        const sl::Lanes bottom = sl::Lanes::broadcast ( bottom_row ), cells = sl::Lanes::broadcast ( board ), col = sl::Lanes::broadcast ( column );
+        sl::Lanes playing = sl::Lanes::broadcast ( ~std::uint64_t { 0 } );
+        for ( std::size_t no_moves = m_no_moves; true; ) {
+            const sl::Lanes vacant = ( ( to_move | just_moved ) + bottom ) & cells;
+            sl::Lanes bit = sl::Lanes::zero ( ), drawing = playing;
+            do {
+                bit = bit | ( vacant & drawing & ( col << mul32 ( bounded ( rng.next ( ), NumCols ), column_height ) ) );
+                drawing = isZero ( bit ) & playing;
+            } while ( bits ( drawing ) );
+            to_move = to_move | bit;
+            const sl::Lanes won = andNot ( isZero ( connected ( to_move ) ), playing );
+            for ( std::uint32_t lanes = bits ( won ); lanes; lanes &= lanes - 1u ) {
+                winners_ [ std::countr_zero ( lanes ) ] = player;
+            }
+            playing = andNot ( won, playing );
+            std::uint32_t left = bits ( playing );
+            if ( not ( left ) ) {
+                return;
+            }
+            if ( NumRows * NumCols == ++no_moves ) {
+                for ( ; left; left &= left - 1u ) {
+                    winners_ [ std::countr_zero ( left ) ] = Player::Type::vacant;
+                }
+                return;
+            }
+            std::swap ( to_move, just_moved );
+            player.next ( );
+        }
+    }
+
+    [[ nodiscard ]] float result ( const Player player_just_moved_ ) const noexcept {
+        return m_winner.vacant ( ) ? 0.0f : ( m_winner == player_just_moved_ ? 1.0f : -1.0f );
+    }
+
+    [[ nodiscard ]] std::optional<Player> ended ( ) const noexcept {
+        return m_winner == Player::Type::invalid ? std::optional<Player> ( ) : std::optional<Player> ( m_winner );
+    }
+
+    void print ( ) const noexcept {
+        static constexpr char player_markers_print [ 3 ] { 'C', '.', 'H' };
+        std::fputs ( " +", stdout );
+        for ( std::size_t col = 0u; col < 2u * NumCols - 1u; ++col ) {
+            std::putchar ( '-' );
+        }
+        std::puts ( "+" );
+        for ( std::size_t row = NumRows; row-- > 0u; ) {
+            std::fputs ( " |", stdout );
+            for ( std::size_t col = 0u; col < NumCols; ++col ) {
+                const std::uint64_t cell = std::uint64_t { 1 } << ( col * column_height + row );
+                const index_t player = m_pieces [ 0 ] & cell ? 0 : ( m_pieces [ 1 ] & cell ? 2 : 1 ); // Agent, vacant, human.
+                std::putchar ( player_markers_print [ player ] );
+                std::putchar ( NumCols - 1u == col ? '|' : ' ' );
+            }
+            std::putchar ( '\n' );
+        }
+        std::fputs ( " +", stdout );
+        for ( std::size_t col = 0u; col < 2u * NumCols - 1u; ++col ) {
+            std::putchar ( '-' );
+        }
+        std::puts ( "+" );
+    }
+
+private:
+
+    friend class cereal::access;
+
+    template < class Archive >
+    void serialize ( Archive & ar_ ) {
+        ar_ ( m_zobrist_hash, m_pieces [ 0 ], m_pieces [ 1 ], m_heights, m_no_moves, m_player_just_moved, m_winner, m_move );
+    }
+};
+
+// The moves are the vacant columns, in column order, the untried moves are a bitmask.
+
+namespace mcts {
+
+    template < std::size_t NumRows, std::size_t NumCols >
+    struct untried_bitmask<BitboardConnectFour<NumRows, NumCols>> : std::true_type { };
+}
@@ -0,0 +1,296 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "thread_pool.hpp"
+#include "topology.hpp"
+
+#include "Typedefs.hpp"
+#include "Globals.hpp"
+#include "player.hpp"
+#include "mcts.hpp"
+
+
+namespace mcts {
+
+    // The budget of every move of a session, whichever of the iterations or
+    // the time (if non-zero) runs out first.
+
+    struct SessionBudget {
+
+        index_t max_iterations = std::numeric_limits<index_t>::max ( );
+        std::chrono::milliseconds time { 0 };
+
+        [[ nodiscard ]] Budget budget ( const CancellationToken * token_ ) const noexcept {
+            Budget budget = time.count ( ) > 0 ? Budget::time ( time, token_ ) : Budget { };
+            budget.max_iterations = max_iterations;
+            budget.token = token_;
+            return budget;
+        }
+    };
+
+
+    struct HostStats {
+
+        index_t no_sessions = 0;
+        std::int64_t no_requests = 0;
+        float mean_queue_latency = 0.0f, max_queue_latency = 0.0f; // Seconds.
+        std::size_t memory = 0u, memory_per_session = 0u; // Bytes.
+
+        void print ( ) const noexcept {
+            printf ( " Sessions %i - Requests %lli - Queue latency %.3f ms (max %.3f ms) - Memory %.1f MB (%.1f KB/Session)\n", no_sessions, ( long long ) no_requests, 1'000.0f * mean_queue_latency, 1'000.0f * max_queue_latency, memory / 1'048'576.0f, memory_per_session / 1'024.0f );
+        }
+    };
+
+
+    // An in-process engine host, owning many sessions (games), each an Mcts plus
+    // its current State. Move requests are scheduled on a shared (work-stealing)
+    // pool, the requests of one session are serialized on the session's mutex.
+    // The tree is pruned after every move, of either side.
+
+    template<typename State>
+    class EngineHost {
+
+    public:
+
+        using Mcts = mcts::Mcts<State>;
+        using Move = typename State::Move;
+        using SessionID = std::uint64_t;
+
+    private:
+
+        struct Session {
+
+            std::mutex mutex;
+            Mcts * mcts = new Mcts ( );
+            State state;
+            SessionBudget budget;
+            CancellationToken token; // Cancelled on close.
+            std::atomic<std::size_t> memory { 0u };
+
+            ~Session ( ) noexcept {
+                delete mcts;
+            }
+
+            void prune ( ) noexcept {
+                Mcts::prune ( mcts, state );
+                memory.store ( mcts->memory ( ) + sizeof ( Session ), std::memory_order_relaxed );
+            }
+        };
+
+        using SessionPtr = std::shared_ptr<Session>;
+
+        std::unordered_map<SessionID, SessionPtr> m_sessions;
+        mutable std::shared_mutex m_sessions_mutex;
+        SessionID m_next_id = 0u;
+        pc::PositionCache * m_position_cache = nullptr;
+
+        // Queue latency, the time between the submission and the start of a request.
+
+        std::atomic<std::int64_t> m_no_requests { 0 }, m_queue_latency { 0 }, m_max_queue_latency { 0 }; // Nanoseconds.
+
+        // Declared last, i.e. destroyed first: the queued requests are finished
+        // while the members they access are still alive.
+
+        tp::ThreadPool m_pool;
+
+        [[ nodiscard ]] SessionPtr find ( const SessionID id_ ) const noexcept {
+            std::shared_lock<std::shared_mutex> lock ( m_sessions_mutex );
+            const auto it = m_sessions.find ( id_ );
+            return m_sessions.cend ( ) == it ? SessionPtr { } : it->second;
+        }
+
+        void recordQueueLatency ( const Clock::duration latency_ ) noexcept {
+            const std::int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds> ( latency_ ).count ( );
+            m_no_requests.fetch_add ( 1, std::memory_order_relaxed );
+            m_queue_latency.fetch_add ( latency, std::memory_order_relaxed );
+            std::int64_t max_latency = m_max_queue_latency.load ( std::memory_order_relaxed );
+            while ( max_latency < latency and not ( m_max_queue_latency.compare_exchange_weak ( max_latency, latency, std::memory_order_relaxed ) ) );
+        }
+
+        [[ nodiscard ]] static std::future<Move> ready ( const Move move_ ) {
+            std::promise<Move> promise;
+            promise.set_value ( move_ );
+            return promise.get_future ( );
+        }
+
+    public:
+
+        explicit EngineHost ( const index_t no_threads_ = topo::usableCores ( ), const topo::Pinning pinning_ = topo::Pinning::scatter ) :
+            m_pool ( no_threads_, pinning_ ) {
+        }
+
+        EngineHost ( const EngineHost & ) = delete;
+        EngineHost & operator = ( const EngineHost & ) = delete;
+
+        ~EngineHost ( ) noexcept {
+            // Cancel the running computes, the pool finishes the queued requests.
+            std::unique_lock<std::shared_mutex> lock ( m_sessions_mutex );
+            for ( auto & session : m_sessions ) {
+                session.second->token.cancel ( );
+            }
+        }
+
+        // The sessions opened from now on share the position_cache_ (not owned,
+        // nullptr to not share), f.e. the positions of the common openings.
+
+        void setPositionCache ( pc::PositionCache * position_cache_ ) noexcept {
+            m_position_cache = position_cache_;
+        }
+
+        // Sessions.
+
+        [[ nodiscard ]] SessionID open ( const SessionBudget & budget_ ) {
+            State state;
+            state.initialize ( );
+            return open ( state, budget_ );
+        }
+
+        [[ nodiscard ]] SessionID open ( const State & state_, const SessionBudget & budget_ ) {
+            SessionPtr session = std::make_shared<Session> ( );
+            session->state = state_;
+            session->budget = budget_;
+            session->mcts->setPositionCache ( m_position_cache );
+            session->prune ( ); // The new Mcts inherits the settings and the position cache, the first compute initializes the tree.
+            std::unique_lock<std::shared_mutex> lock ( m_sessions_mutex );
+            const SessionID id = m_next_id++;
+            m_sessions.emplace ( id, std::move ( session ) );
+            return id;
+        }
+
+        // A request of a closed session returns Move::invalid, a running compute
+        // is cancelled and the session is destroyed after it returns.
+
+        void close ( const SessionID id_ ) noexcept {
+            SessionPtr session;
+            {
+                std::unique_lock<std::shared_mutex> lock ( m_sessions_mutex );
+                const auto it = m_sessions.find ( id_ );
+                if ( m_sessions.cend ( ) == it ) {
+                    return;
+                }
+                session = std::move ( it->second );
+                m_sessions.erase ( it );
+            }
+            session->token.cancel ( );
+        }
+
+        void setBudget ( const SessionID id_, const SessionBudget & budget_ ) noexcept {
+            if ( SessionPtr session = find ( id_ ) ) {
+                std::lock_guard<std::mutex> lock ( session->mutex );
+                session->budget = budget_;
+            }
+        }
+
+        [[ nodiscard ]] index_t size ( ) const noexcept {
+            std::shared_lock<std::shared_mutex> lock ( m_sessions_mutex );
+            return ( index_t ) m_sessions.size ( );
+        }
+
+        // Moves.
+
+        // Computes (and plays) the move of the player to move in the session,
+        // Move::invalid if the session is closed or the game has ended.
+
+        [[ nodiscard ]] std::future<Move> requestMove ( const SessionID id_ ) {
+            SessionPtr session = find ( id_ );
+            if ( not ( session ) ) {
+                return ready ( Move::invalid );
+            }
+            return m_pool.submit ( [ this, session = std::move ( session ), submitted = Clock::now ( ) ] ( ) {
+                recordQueueLatency ( Clock::now ( ) - submitted );
+                std::lock_guard<std::mutex> lock ( session->mutex );
+                if ( session->token.cancelled ( ) or session->state.ended ( ) ) {
+                    return Move::invalid;
+                }
+                const Move move = session->mcts->compute ( session->state, session->budget.budget ( & session->token ) );
+                session->state.move_hash_winner ( move );
+                session->prune ( );
+                return move;
+            } );
+        }
+
+        // Plays the move of the opponent, returns false if the session is closed
+        // or the game has ended.
+
+        [[ maybe_unused ]] bool play ( const SessionID id_, const Move move_ ) noexcept {
+            SessionPtr session = find ( id_ );
+            if ( not ( session ) ) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock ( session->mutex );
+            if ( session->state.ended ( ) ) {
+                return false;
+            }
+            session->state.move_hash_winner ( move_ );
+            session->prune ( );
+            return true;
+        }
+
+        [[ nodiscard ]] std::optional<State> state ( const SessionID id_ ) const noexcept {
+            SessionPtr session = find ( id_ );
+            if ( not ( session ) ) {
+                return { };
+            }
+            std::lock_guard<std::mutex> lock ( session->mutex );
+            return session->state;
+        }
+
+        // Statistics, the memory is as of the last move of each session.
+
+        [[ nodiscard ]] HostStats stats ( ) const noexcept {
+            HostStats stats;
+            {
+                std::shared_lock<std::shared_mutex> lock ( m_sessions_mutex );
+                stats.no_sessions = ( index_t ) m_sessions.size ( );
+                for ( const auto & session : m_sessions ) {
+                    stats.memory += session.second->memory.load ( std::memory_order_relaxed );
+                }
+            }
+            stats.memory_per_session = stats.no_sessions ? stats.memory / stats.no_sessions : 0u;
+            stats.no_requests = m_no_requests.load ( std::memory_order_relaxed );
+            if ( stats.no_requests ) {
+                stats.mean_queue_latency = m_queue_latency.load ( std::memory_order_relaxed ) / ( 1e9f * stats.no_requests );
+            }
+            stats.max_queue_latency = m_max_queue_latency.load ( std::memory_order_relaxed ) / 1e9f;
+            return stats;
+        }
+    };
+}
@@ -43,12 +43,14 @@ Does #define BOOST_SP_USE_STD_ATOMIC work for clang-cl and clang/c2?
 
 */
 
+#include <atomic>
 #include <filesystem>
 #include <random>
 
 namespace fs = std::filesystem;
 
 #include "splitmix.hpp"
+#include "topology.hpp"
 
 #include <SFML/Graphics.hpp>
 
@@ -60,7 +62,16 @@ using rng_t = splitmix64;
 std::uint64_t g_seed = 0;
 
 
-rng_t g_rng ( 1234567890u );
+// Every thread gets its own generator, the first thread (the main thread) is
+// seeded as before, the threads thereafter each get the next seed of the
+// sequence, i.e. search threads don't share (and contend for) one generator.
+
+[[ nodiscard ]] std::uint64_t thread_seed ( ) noexcept {
+    static std::atomic<std::uint64_t> seed { 1234567890u };
+    return seed.fetch_add ( 0x9e3779b97f4a7c15, std::memory_order_relaxed );
+}
+
+thread_local rng_t g_rng ( thread_seed ( ) );
 // rng_t g_rng;
 
 
@@ -75,9 +86,13 @@ void seed ( const std::uint64_t seed_ ) noexcept {
 }
 
 
+[[ nodiscard ]] bool bernoulli ( rng_t & rng_ ) noexcept {
+    static thread_local std::bernoulli_distribution g_bernoulli_distribution;
+    return g_bernoulli_distribution ( rng_ );
+}
+
 [[ nodiscard ]] bool bernoulli ( ) noexcept {
-    static std::bernoulli_distribution g_bernoulli_distribution;
-    return g_bernoulli_distribution ( g_rng );
+    return bernoulli ( g_rng );
 }
 
 
@@ -109,9 +124,8 @@ const fs::path app_path_ = getExePath ( );
 fs::path & g_app_path = const_cast<fs::path &> ( app_path_ );
 
 
+// The usable cores, i.e. the affinity mask limited by the cgroup cpu quota.
+
 [[ nodiscard ]] std::int32_t getNumberOfProcessors ( ) noexcept {
-    char *value;
-    std::size_t len;
-    _dupenv_s ( & value, & len, "NUMBER_OF_PROCESSORS" );
-    return std::atoi ( value );
+    return topo::usableCores ( );
 }
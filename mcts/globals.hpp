@@ -58,12 +58,13 @@ extern sf::Clock g_clock;
 using rng_t = splitmix64;
 
 extern std::uint64_t g_seed;
-extern rng_t g_rng;
+extern thread_local rng_t g_rng;
 
 [[ nodiscard ]] std::uint64_t next_seed ( ) noexcept;
 void seed ( const std::uint64_t seed_ ) noexcept;
 
 [[ nodiscard ]] bool bernoulli ( ) noexcept;
+[[ nodiscard ]] bool bernoulli ( rng_t & rng_ ) noexcept;
 
 extern std::int32_t g_max;
 
@@ -0,0 +1,134 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace pa {
+
+    // A pool of T's addressed by 32-bit handles instead of pointers, handle 0
+    // is the null handle. The elements live in chunks of ChunkSize slots, the
+    // chunks are never moved or released before the pool is destroyed, so
+    // elements are accessed without synchronization, the allocation and
+    // deallocation of elements must be guarded by the caller. Running out of
+    // the ChunkSize * MaxChunks - 1 handles throws std::bad_alloc.
+
+    template<typename T, std::size_t ChunkSize = 4'096, std::size_t MaxChunks = 16'384>
+    class indexed_pool {
+
+        public:
+
+        using value_type = T;
+        using handle_type = std::uint32_t;
+        using size_type = std::size_t;
+
+        static constexpr handle_type null_handle = 0u;
+
+        private:
+
+        struct alignas ( T ) Slot {
+            std::byte data [ sizeof ( T ) ];
+        };
+
+        std::unique_ptr<Slot [ ]> m_chunks [ MaxChunks ];
+        std::vector<handle_type> m_free_handles;
+        handle_type m_end = 1u; // One past the last handle handed out, 0 is null.
+
+        [[ nodiscard ]] T * address ( const handle_type h_ ) const noexcept {
+            return std::launder ( reinterpret_cast<T *> ( m_chunks [ h_ / ChunkSize ] [ h_ % ChunkSize ].data ) );
+        }
+
+        public:
+
+        static_assert ( ChunkSize * MaxChunks <= std::size_t { 1 } << 32, "handles are 32 bits" );
+
+        indexed_pool ( ) noexcept { }
+        indexed_pool ( const indexed_pool & ) = delete;
+        indexed_pool & operator = ( const indexed_pool & ) = delete;
+
+        ~indexed_pool ( ) noexcept {
+            // Destroy the live elements, the handles not in the free list.
+            std::vector<bool> free ( m_end, false );
+            for ( const handle_type h : m_free_handles ) {
+                free [ h ] = true;
+            }
+            for ( handle_type h = 1u; h < m_end; ++h ) {
+                if ( not ( free [ h ] ) ) {
+                    address ( h )->~T ( );
+                }
+            }
+        }
+
+        template<typename ... Args>
+        [[ nodiscard ]] handle_type new_element ( Args && ... args_ ) {
+            handle_type h;
+            if ( m_free_handles.size ( ) ) {
+                h = m_free_handles.back ( );
+                m_free_handles.pop_back ( );
+            }
+            else {
+                if ( m_end / ChunkSize >= MaxChunks ) { // Out of handles.
+                    throw std::bad_alloc ( );
+                }
+                h = m_end++;
+                if ( nullptr == m_chunks [ h / ChunkSize ] ) {
+                    m_chunks [ h / ChunkSize ].reset ( new Slot [ ChunkSize ] );
+                }
+            }
+            new ( m_chunks [ h / ChunkSize ] [ h % ChunkSize ].data ) T ( std::forward<Args> ( args_ ) ... );
+            return h;
+        }
+
+        void delete_element ( const handle_type h_ ) noexcept {
+            if ( null_handle != h_ ) {
+                address ( h_ )->~T ( );
+                m_free_handles.push_back ( h_ );
+            }
+        }
+
+        [[ nodiscard ]] T & operator [ ] ( const handle_type h_ ) noexcept {
+            return * address ( h_ );
+        }
+
+        [[ nodiscard ]] const T & operator [ ] ( const handle_type h_ ) const noexcept {
+            return * address ( h_ );
+        }
+
+        [[ nodiscard ]] size_type size ( ) const noexcept {
+            return m_end - 1u - m_free_handles.size ( );
+        }
+
+        [[ nodiscard ]] size_type memory_size ( ) const noexcept {
+            return ( ( m_end + ChunkSize - 1u ) / ChunkSize ) * ChunkSize * sizeof ( Slot ) + m_free_handles.capacity ( ) * sizeof ( handle_type );
+        }
+    };
+}
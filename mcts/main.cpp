@@ -26,6 +26,8 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include <cwchar>
+
 #include <iostream>
 
 #include "autotimer.hpp"
@@ -36,22 +38,66 @@
 #include "Moves.hpp"
 
 #define CF 0
+#define PONDER 0
+#define MATCH_RUNNER 0
+#define BENCHMARK_LAYOUTS 0
 
 #if CF
-#include "connect_four.hpp"
+#include "connect_four_bitboard.hpp"
 #else
 #include "Oska.hpp"
 #endif
 
 #include "mcts.hpp"
+#include "match_runner.hpp"
+#include "benchmark.hpp"
+#include "checks.hpp"
 
 
-int wmain ( ) {
+int wmain ( int argc_, wchar_t * argv_ [ ] ) {
 #if CF
-    typedef ConnectFour<> State;
+    typedef BitboardConnectFour<> State;
 #else
     typedef OskaStateTemplate<5> State;
 #endif
+    if ( argc_ > 1 and 0 == std::wcscmp ( argv_ [ 1 ], L"--check" ) ) {
+        bool passed = check::all<State> ( );
+#if CF
+        passed = check::bitboard<ConnectFour<>, BitboardConnectFour<>> ( "bitboard against matrix ConnectFour" ) and passed;
+        passed = check::batchPlayouts<BitboardConnectFour<>> ( "batch playouts" ) and passed;
+#endif
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+#if BENCHMARK_LAYOUTS
+    bench::layouts<State> ( );
+    bench::trees<State> ( );
+    bench::parallel<State, mcts::ContiguousChildren> ( );
+    bench::memoryBudget<State, mcts::ContiguousChildren> ( 1'000'000, 16u * 1'048'576u );
+    bench::nodeEncodings<State> ( );
+    bench::uctKernel ( 7 );
+    bench::uctKernel ( State::max_no_moves );
+    bench::prunes<State> ( );
+    bench::compaction<State> ( );
+    bench::statistics<State> ( );
+    bench::positionCache<State> ( );
+#if CF
+    bench::playouts<ConnectFour<>> ( "matrix" );
+    bench::playouts<BitboardConnectFour<>> ( "bitboard" );
+    bench::batchPlayouts<BitboardConnectFour<>> ( "bitboard, batches" );
+#endif
+    bench::pageSizes ( );
+    return EXIT_SUCCESS;
+#endif
+#if MATCH_RUNNER
+    // The matches are played concurrently, one match per usable core, the
+    // workers are pinned one per physical core first.
+    mcts::MatchRunner<State> match_runner ( 20'000, 2'000 );
+    putchar ( '\n' );
+    topo::Topology::instance ( ).print ( );
+    [[ maybe_unused ]] const mcts::MatchStats stats = match_runner.run ( 1000 );
+    putchar ( '\n' );
+    return EXIT_SUCCESS;
+#else
     using Mcts = mcts::Mcts<State>;
     std::optional<Player> winner;
     std::uint32_t matches = 0u, agent_wins = 0u, human_wins = 0u;
@@ -64,7 +110,14 @@ int wmain ( ) {
             Mcts * mcts_agent = new Mcts ( ), * mcts_human = new Mcts ( );
             match_start = now ( );
             do {
+#if PONDER
+                // The player that just moved ponders, while the opponent computes.
+                Mcts * mcts_to_move = state.playerToMove ( ) == Player::Type::agent ? mcts_agent : mcts_human;
+                state.move_hash_winner ( mcts_to_move->compute ( state, mcts_to_move == mcts_agent ? 20'000 : 2'000 ) );
+                mcts_to_move->startPondering ( state );
+#else
                 state.move_hash_winner ( state.playerToMove ( ) == Player::Type::agent ? mcts_agent->compute ( state, 20'000 ) : mcts_human->compute ( state, 2'000 ) );
+#endif
                 Mcts::prune ( state.playerToMove ( ) == Player::Type::agent ? mcts_agent : mcts_human, state );
             } while ( not ( winner = state.ended ( ) ) );
 #if 0
@@ -99,4 +152,5 @@ int wmain ( ) {
     }
 
     return EXIT_SUCCESS;
+#endif
 }
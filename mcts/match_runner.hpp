@@ -0,0 +1,184 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.hpp"
+#include "topology.hpp"
+
+#include "Typedefs.hpp"
+#include "Globals.hpp"
+#include "player.hpp"
+#include "mcts.hpp"
+
+
+namespace mcts {
+
+    // The aggregate of a number of matches. The seconds are the sum of the
+    // durations of the individual matches, the wall_seconds the duration of
+    // the run as a whole.
+
+    struct MatchStats {
+
+        std::uint32_t matches = 0u, agent_wins = 0u, human_wins = 0u, draws = 0u;
+        float seconds = 0.0f, wall_seconds = 0.0f;
+
+        void add ( const Player winner_, const float seconds_ ) noexcept {
+            ++matches;
+            switch ( winner_.as_index ( ) ) {
+                case ( index_t ) Player::Type::agent: ++agent_wins; break;
+                case ( index_t ) Player::Type::human: ++human_wins; break;
+                case ( index_t ) Player::Type::vacant: ++draws; break;
+                NO_DEFAULT_CASE;
+            }
+            seconds += seconds_;
+        }
+
+        [[ nodiscard ]] float matchesPerSecond ( ) const noexcept {
+            return wall_seconds > 0.0f ? matches / wall_seconds : 0.0f;
+        }
+
+        void print ( ) const noexcept {
+            // Percentages are truncated to one decimal.
+            const auto percentage = [ this ] ( const std::uint32_t n_ ) { return ( ( int ) ( ( 1000.0f * n_ ) / float ( matches ) ) ) / 10.0f; };
+            printf ( "\r Match %i: Agent%6.1f%% - Human%6.1f%% - Draw%6.1f%% (%.1f Sec./Match - %.1f Sec. - %.2f Matches/Sec.)", matches, percentage ( agent_wins ), percentage ( human_wins ), percentage ( draws ), seconds / ( float ) matches, wall_seconds, matchesPerSecond ( ) );
+        }
+    };
+
+
+    // Plays matches of Agent ( agent_iterations ) vs Human ( human_iterations )
+    // concurrently, one match per task on a work-stealing pool. Every match gets
+    // its own pair of Mcts instances and its own random number stream (split
+    // off from the runner's stream in order of submission), i.e. the outcome of
+    // a run does not depend on the scheduling of the matches.
+
+    template<typename State>
+    class MatchRunner {
+
+        using Mcts = mcts::Mcts<State>;
+
+        struct MatchResult {
+            Player winner;
+            float seconds;
+        };
+
+        // The static tables of State (f.e. the zobrist keys of Oska, drawn from
+        // g_rng) are set up from a fixed seed, on construction, before the
+        // workers start, instead of from the stream of whichever match gets to
+        // initialize a State first.
+
+        static constexpr std::uint64_t tables_seed = 0x9e37'79b9'7f4a'7c15ull;
+
+        [[ nodiscard ]] static bool initializeTables ( ) noexcept {
+            const rng_t rng = g_rng;
+            g_rng.seed ( tables_seed );
+            State state;
+            state.initialize ( );
+            g_rng = rng;
+            return true;
+        }
+
+        bool m_tables_initialized = initializeTables ( ); // Before m_pool.
+        tp::ThreadPool m_pool;
+        index_t m_agent_iterations, m_human_iterations;
+        rng_t m_rng { g_rng.split ( ) };
+        pc::PositionCache * m_position_cache = nullptr;
+
+        [[ nodiscard ]] MatchResult play ( const rng_t rng_ ) const noexcept {
+            // The thread-local stream is reseeded for the duration of the match, as
+            // State::initialize ( ) (the first player) and the Mcts instances draw
+            // from it.
+            g_rng = rng_;
+            const sf::Time match_start = now ( );
+            State state;
+            state.initialize ( );
+            Mcts * mcts_agent = new Mcts ( ), * mcts_human = new Mcts ( );
+            if ( nullptr != m_position_cache ) {
+                mcts_agent->setPositionCache ( m_position_cache );
+                mcts_human->setPositionCache ( m_position_cache );
+            }
+            std::optional<Player> winner;
+            do {
+                state.move_hash_winner ( state.playerToMove ( ) == Player::Type::agent ? mcts_agent->compute ( state, m_agent_iterations ) : mcts_human->compute ( state, m_human_iterations ) );
+                Mcts::prune ( state.playerToMove ( ) == Player::Type::agent ? mcts_agent : mcts_human, state );
+            } while ( not ( winner = state.ended ( ) ) );
+            delete mcts_human;
+            delete mcts_agent;
+            return { * winner, since ( match_start ).asSeconds ( ) };
+        }
+
+    public:
+
+        MatchRunner ( const index_t agent_iterations_, const index_t human_iterations_, const index_t no_threads_ = topo::usableCores ( ), const topo::Pinning pinning_ = topo::Pinning::scatter ) :
+            m_pool ( no_threads_, pinning_ ),
+            m_agent_iterations ( agent_iterations_ ),
+            m_human_iterations ( human_iterations_ ) {
+        }
+
+        void seed ( const std::uint64_t seed_ ) noexcept {
+            m_rng.seed ( seed_ );
+        }
+
+        [[ nodiscard ]] index_t size ( ) const noexcept {
+            return m_pool.size ( );
+        }
+
+        // The engines of all matches share the position_cache_ (not owned, nullptr
+        // to not share), the outcome of a run then depends on the scheduling.
+
+        void setPositionCache ( pc::PositionCache * position_cache_ ) noexcept {
+            m_position_cache = position_cache_;
+        }
+
+        // Plays no_matches_ matches, the progress is printed (in order of
+        // submission) as the matches complete, if print_ is true.
+
+        [[ nodiscard ]] MatchStats run ( const index_t no_matches_, const bool print_ = true ) {
+            MatchStats stats;
+            const sf::Time start = now ( );
+            std::vector<std::future<MatchResult>> matches;
+            matches.reserve ( no_matches_ );
+            for ( index_t i = 0; i < no_matches_; ++i ) {
+                matches.push_back ( m_pool.submit ( [ this, rng = m_rng.split ( ) ] ( ) { return play ( rng ); } ) );
+            }
+            for ( std::future<MatchResult> & match : matches ) {
+                const MatchResult result = match.get ( );
+                stats.add ( result.winner, result.seconds );
+                stats.wall_seconds = since ( start ).asSeconds ( );
+                if ( print_ ) {
+                    stats.print ( );
+                }
+            }
+            return stats;
+        }
+    };
+}
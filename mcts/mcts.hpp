@@ -24,27 +24,46 @@
 #pragma once
 
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cmath>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <numeric>
 #include <random>
-#include <unordered_map>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include <boost/dynamic_bitset.hpp>
 #include <boost/container/static_vector.hpp>
 
 #include <cereal/cereal.hpp>
-#include <cereal/types/unordered_map.hpp>
 #include <cereal/archives/binary.hpp>
 
 #include "owningptr.hpp"
 #include "pool_allocator.hpp"
+#include "indexed_pool.hpp"
+#include "untried_moves.hpp"
 
 #include "autotimer.hpp"
+#include "thread_pool.hpp"
+#include "topology.hpp"
+#include "transposition_table.hpp"
+#include "position_cache.hpp"
+#include "node_stats.hpp"
+#include "uct_simd.hpp"
+#include "block_tree.hpp"
 
 #include "Typedefs.hpp"
+#include "Globals.hpp"
 #include "player.hpp"
 #include "flat_search_tree.hpp"
 
@@ -170,65 +189,119 @@ namespace mcts {
     };
 
 
+    // The arc record of the arc statistics modes (see ArcUCT3 and ArcMax), the
+    // visits and score of the playouts through this arc, i.e. of one parent of
+    // the target only. The score is to the player just moved in the target.
 
     template<typename State>
-    struct NodeData { // 17 bytes.
+    struct ArcStatsData : ArcData<State> { // 12 bytes (a 1-byte move, padded to 4 bytes).
+
+        float m_score = 0.0f; // 4 bytes.
+        std::int32_t m_visits = 0; // 4 bytes.
+
+        ArcStatsData ( ) noexcept { }
+        ArcStatsData ( const State & state_ ) noexcept : ArcData<State> ( state_ ) { }
+
+        [[ maybe_unused ]] ArcStatsData & operator += ( const ArcStatsData & rhs_ ) noexcept {
+            m_score += rhs_.m_score;
+            m_visits += rhs_.m_visits;
+            return * this;
+        }
+
+        void add ( const float score_, const std::int32_t visits_ ) noexcept {
+            m_score += score_;
+            m_visits += visits_;
+        }
+
+        // Relaxed atomic access, as with NodeData.
+
+        [[ nodiscard ]] float score ( ) const noexcept {
+            return std::atomic_ref<float> ( const_cast<float &> ( m_score ) ).load ( std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] std::int32_t visits ( ) const noexcept {
+            return std::atomic_ref<std::int32_t> ( const_cast<std::int32_t &> ( m_visits ) ).load ( std::memory_order_relaxed );
+        }
+
+        void atomicAdd ( const float score_, const std::int32_t visits_ ) noexcept {
+            std::atomic_ref<float> ( m_score ).fetch_add ( score_, std::memory_order_relaxed );
+            std::atomic_ref<std::int32_t> ( m_visits ).fetch_add ( visits_, std::memory_order_relaxed );
+        }
+
+        // The score is replaced by value_ (the mean) times the visits.
+
+        void assignValue ( const float value_ ) noexcept {
+            std::atomic_ref<float> ( m_score ).store ( value_ * ( float ) visits ( ), std::memory_order_relaxed );
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void serialize ( Archive & ar_ ) {
+            ar_ ( this->m_move, m_score, m_visits );
+        }
+    };
+
+
+
+    template<typename State>
+    struct NodeData { // 17 bytes (with a pooled Moves), 10 bytes (with a bitmask).
 
         using state_type = State;
         using Moves = typename State::Moves;
         using Move = typename State::Moves::value_type;
-        using MovesPool = pa::pool_allocator<Moves>;
-        using MovesPoolPtr = llvm::OwningPtr<MovesPool>;
+        using UntriedMoves = mcts::UntriedMoves<State, PooledMoves>;
 
-        Moves * m_moves = nullptr;  // 8 bytes.
+        UntriedMoves m_moves;  // 8 bytes, or 1 to 8 bytes.
+        Player m_player_just_moved = Player::Type::invalid; // 1 byte.
         float m_score = 0.0f; // 4 bytes.
         std::int32_t m_visits = 0; // 4 bytes.
-        Player m_player_just_moved = Player::Type::invalid; // 1 byte.
 
         // Constructors.
 
         NodeData ( ) noexcept {
             // std::cout << "nodedata default constructed\n";
         }
-        NodeData ( const State & state_ ) noexcept {
+        NodeData ( const State & state_ ) noexcept : m_moves ( state_ ) {
             // std::cout << "nodedata constructed from state\n";
-            m_moves = m_moves_pool->new_element ( );
-            if ( not ( state_.moves ( m_moves ) ) ) {
-                m_moves_pool->delete_element ( m_moves );
-                m_moves = nullptr;
-            }
             m_player_just_moved = state_.playerJustMoved ( );
         }
-        NodeData ( const NodeData & nd_ ) noexcept {
+        NodeData ( const NodeData & nd_ ) noexcept : m_moves ( nd_.m_moves ) {
             // std::cout << "nodedata copy constructed\n";
-            if ( nd_.m_moves != nullptr ) {
-                m_moves = m_moves_pool->new_element ( * nd_.m_moves );
-            }
             m_score = nd_.m_score;
             m_visits = nd_.m_visits;
             m_player_just_moved = nd_.m_player_just_moved;
         }
-        NodeData ( NodeData && nd_ ) noexcept {
+        NodeData ( NodeData && nd_ ) noexcept : m_moves ( std::move ( nd_.m_moves ) ) {
             // std::cout << "nodedata move constructed\n";
-            std::swap ( m_moves, nd_.m_moves );
             m_score = std::move ( nd_.m_score );
             m_visits = std::move ( nd_.m_visits );
             m_player_just_moved = std::move ( nd_.m_player_just_moved );
         }
 
-        ~NodeData ( ) noexcept {
-            m_moves_pool->delete_element ( m_moves ); // Checked for nullptr in delete_element ( ... ).
+        // The state_ is the state of this node.
+
+        [[ nodiscard ]] Move getUntriedMove ( const State & state_, rng_t & rng_ ) noexcept {
+            return m_moves.draw ( state_, rng_ );
         }
 
-        [[ nodiscard ]] Move getUntriedMove ( ) noexcept {
-            if ( 1 == m_moves->size ( ) ) {
-                // 1 move left, so destroy memory and return that 1 move.
-                const Move move = m_moves->front ( );
-                m_moves_pool->delete_element ( m_moves );
-                m_moves = nullptr;
-                return move;
-            }
-            return m_moves->draw ( );
+        [[ nodiscard ]] bool hasUntriedMoves ( ) const noexcept {
+            return m_moves.any ( );
+        }
+
+        // All moves are untried again (the node lost its children), the
+        // statistics are kept.
+
+        void resetMoves ( const State & state_ ) noexcept {
+            m_moves.reset ( state_ );
+        }
+
+        // Merging a node of the same position, the moves tried in either are tried.
+
+        void retainUntriedMoves ( const NodeData & rhs_ ) noexcept {
+            m_moves.retain ( rhs_.m_moves );
         }
 
         [[ maybe_unused ]] NodeData & operator += ( const NodeData & rhs_ ) noexcept {
@@ -237,11 +310,34 @@ namespace mcts {
             return * this;
         }
 
+        void add ( const float score_, const std::int32_t visits_ ) noexcept {
+            m_score += score_;
+            m_visits += visits_;
+        }
+
+        [[ nodiscard ]] Player playerJustMoved ( ) const noexcept {
+            return m_player_just_moved;
+        }
+
+        // Relaxed atomic access to the statistics, as required by a tree-parallel
+        // search. The loads compile to plain loads, so these are used throughout.
+
+        [[ nodiscard ]] float score ( ) const noexcept {
+            return std::atomic_ref<float> ( const_cast<float &> ( m_score ) ).load ( std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] std::int32_t visits ( ) const noexcept {
+            return std::atomic_ref<std::int32_t> ( const_cast<std::int32_t &> ( m_visits ) ).load ( std::memory_order_relaxed );
+        }
+
+        void atomicAdd ( const float score_, const std::int32_t visits_ ) noexcept {
+            std::atomic_ref<float> ( m_score ).fetch_add ( score_, std::memory_order_relaxed );
+            std::atomic_ref<std::int32_t> ( m_visits ).fetch_add ( visits_, std::memory_order_relaxed );
+        }
+
         [[ maybe_unused ]] NodeData & operator = ( const NodeData & nd_ ) noexcept {
             // std::cout << "nodedata copy assigned\n";
-            if ( nullptr != nd_.m_moves ) {
-                m_moves = m_moves_pool->new_element ( * nd_.m_moves );
-            }
+            m_moves = nd_.m_moves;
             m_score = nd_.m_score;
             m_visits = nd_.m_visits;
             m_player_just_moved = nd_.m_player_just_moved;
@@ -250,47 +346,230 @@ namespace mcts {
 
         [[ maybe_unused ]] NodeData & operator = ( NodeData && nd_ ) noexcept {
             // std::cout << "nodedata move assigned\n";
-            std::swap ( m_moves, nd_.m_moves );
+            m_moves = std::move ( nd_.m_moves );
             m_score = std::move ( nd_.m_score );
             m_visits = std::move ( nd_.m_visits );
             m_player_just_moved = std::move ( nd_.m_player_just_moved );
             return * this;
         }
 
-        static MovesPoolPtr m_moves_pool;
-
     private:
 
         friend class cereal::access;
 
         template < class Archive >
-        void save ( Archive & ar_ ) const noexcept {
-            if ( nullptr != m_moves ) {
-                const std::int8_t tmp = 2;
-                ar_ ( tmp );
-                m_moves->serialize ( ar_ );
-            }
-            else {
-                const std::int8_t tmp = 1;
-                ar_ ( tmp );
-            }
-            ar_ ( m_score, m_visits, m_player_just_moved );
+        void serialize ( Archive & ar_ ) {
+            ar_ ( m_moves, m_score, m_visits, m_player_just_moved );
+        }
+    };
+
+
+    // The node record of the struct of arrays layout, the untried moves only,
+    // the statistics are kept in a NodeStats (apart from the tree).
+
+    template<typename State>
+    struct MovesData { // 8 bytes (with a pooled Moves), 1 to 8 bytes (with a bitmask).
+
+        using state_type = State;
+        using Moves = typename State::Moves;
+        using Move = typename State::Moves::value_type;
+        using UntriedMoves = mcts::UntriedMoves<State, PooledMoves>;
+
+        UntriedMoves m_moves;
+
+        MovesData ( ) noexcept {
+        }
+        MovesData ( const State & state_ ) noexcept : m_moves ( state_ ) {
+        }
+
+        [[ nodiscard ]] Move getUntriedMove ( const State & state_, rng_t & rng_ ) noexcept {
+            return m_moves.draw ( state_, rng_ );
+        }
+
+        [[ nodiscard ]] bool hasUntriedMoves ( ) const noexcept {
+            return m_moves.any ( );
+        }
+
+        void resetMoves ( const State & state_ ) noexcept {
+            m_moves.reset ( state_ );
+        }
+
+        void retainUntriedMoves ( const MovesData & rhs_ ) noexcept {
+            m_moves.retain ( rhs_.m_moves );
+        }
+
+        [[ maybe_unused ]] MovesData & operator += ( const MovesData & ) noexcept {
+            return * this;
         }
 
+    private:
+
+        friend class cereal::access;
+
         template < class Archive >
-        void load ( Archive & ar_ ) noexcept {
-            std::int8_t tmp = -1;
-            ar_ ( tmp );
-            if ( 2 == tmp ) {
-                m_moves = m_moves_pool->new_element ( );
-                m_moves->serialize ( ar_ );
-            }
-            ar_ ( m_score, m_visits, m_player_just_moved );
+        void serialize ( Archive & ar_ ) {
+            ar_ ( m_moves );
         }
     };
 
+
+    // The compact node record, 12 bytes instead of the 24 bytes (after padding)
+    // of NodeData. The untried moves are referred to by a 32-bit handle into an
+    // indexed pool, instead of by pointer (or are a bitmask). The results are
+    // +1, 0 or -1, so the score (wins minus losses) is an integer, which is
+    // exact where a float stops counting single results at 2^24 visits. The
+    // player just moved is packed into the top 2 bits of the visits.
+
     template<typename State>
-    typename NodeData<State>::MovesPoolPtr NodeData<State>::m_moves_pool ( new MovesPool ( ) );
+    struct CompactNodeData { // 12 bytes.
+
+        using state_type = State;
+        using Moves = typename State::Moves;
+        using Move = typename State::Moves::value_type;
+        using UntriedMoves = mcts::UntriedMoves<State, IndexedMoves>;
+
+        static constexpr std::uint32_t visits_bits = 30u, visits_mask = ( 1u << visits_bits ) - 1u;
+
+        UntriedMoves m_moves; // 4 bytes, or 1 to 4 bytes.
+        std::int32_t m_score = 0; // 4 bytes.
+        std::uint32_t m_visits_player = packPlayer ( Player::Type::invalid ); // 4 bytes.
+
+        CompactNodeData ( ) noexcept {
+        }
+        CompactNodeData ( const State & state_ ) noexcept : m_moves ( state_ ) {
+            m_visits_player = packPlayer ( state_.playerJustMoved ( ) );
+        }
+
+        [[ nodiscard ]] Move getUntriedMove ( const State & state_, rng_t & rng_ ) noexcept {
+            return m_moves.draw ( state_, rng_ );
+        }
+
+        [[ nodiscard ]] bool hasUntriedMoves ( ) const noexcept {
+            return m_moves.any ( );
+        }
+
+        void resetMoves ( const State & state_ ) noexcept {
+            m_moves.reset ( state_ );
+        }
+
+        void retainUntriedMoves ( const CompactNodeData & rhs_ ) noexcept {
+            m_moves.retain ( rhs_.m_moves );
+        }
+
+        [[ maybe_unused ]] CompactNodeData & operator += ( const CompactNodeData & rhs_ ) noexcept {
+            add ( ( float ) rhs_.m_score, rhs_.visits ( ) );
+            return * this;
+        }
+
+        void add ( const float score_, const std::int32_t visits_ ) noexcept {
+            m_score += ( std::int32_t ) std::lround ( score_ );
+            m_visits_player += ( std::uint32_t ) visits_; // Modulo 2^32, the player bits don't change.
+        }
+
+        // Relaxed atomic access, as in NodeData.
+
+        [[ nodiscard ]] float score ( ) const noexcept {
+            return ( float ) std::atomic_ref<std::int32_t> ( const_cast<std::int32_t &> ( m_score ) ).load ( std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] std::int32_t visits ( ) const noexcept {
+            return ( std::int32_t ) ( std::atomic_ref<std::uint32_t> ( const_cast<std::uint32_t &> ( m_visits_player ) ).load ( std::memory_order_relaxed ) & visits_mask );
+        }
+
+        void atomicAdd ( const float score_, const std::int32_t visits_ ) noexcept {
+            std::atomic_ref<std::int32_t> ( m_score ).fetch_add ( ( std::int32_t ) std::lround ( score_ ), std::memory_order_relaxed );
+            std::atomic_ref<std::uint32_t> ( m_visits_player ).fetch_add ( ( std::uint32_t ) visits_, std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] Player playerJustMoved ( ) const noexcept {
+            return ( Player::Type ) ( ( std::int32_t ) ( m_visits_player >> visits_bits ) - 2 );
+        }
+
+        [[ nodiscard ]] static std::uint32_t packPlayer ( const Player player_ ) noexcept {
+            return ( std::uint32_t ) ( ( std::int32_t ) player_.get ( ) + 2 ) << visits_bits; // invalid (-2) .. human (1).
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void serialize ( Archive & ar_ ) {
+            ar_ ( m_moves, m_score, m_visits_player );
+        }
+    };
+
+
+    // The layout of the node statistics and the tree, the second template
+    // parameter of Mcts. ArrayOfStructs keeps the statistics in the node records
+    // (NodeData), with StructOfArrays the node records hold the untried moves
+    // only (MovesData) and the statistics are kept in parallel arrays (NodeStats).
+    // ContiguousChildren stores the out-arcs of a node in one block (BlockTree),
+    // instead of in the linked lists of fst::SearchTree. Compact combines the
+    // BlockTree (32-bit ids) with the 12-byte CompactNodeData, a BlockTree node
+    // record is 20 bytes instead of 32 (with NodeData), i.e. 53.7M instead of
+    // 33.5M node records per GB. The blocks (8 bytes per arc), the untried
+    // moves and the transposition table come on top, bench::nodesPerGB ( )
+    // measures the whole.
+
+    struct ArrayOfStructs {
+        static constexpr bool struct_of_arrays = false;
+        template<typename State>
+        using node_data = NodeData<State>;
+        template<typename State, typename NodeData_, typename ArcData_ = ArcData<State>>
+        using tree = fst::SearchTree<ArcData_, NodeData_>;
+    };
+
+    struct StructOfArrays {
+        static constexpr bool struct_of_arrays = true;
+        template<typename State>
+        using node_data = MovesData<State>;
+        template<typename State, typename NodeData_, typename ArcData_ = ArcData<State>>
+        using tree = fst::SearchTree<ArcData_, NodeData_>;
+    };
+
+    struct ContiguousChildren : ArrayOfStructs {
+        template<typename State, typename NodeData_, typename ArcData_ = ArcData<State>>
+        using tree = bt::BlockTree<ArcData_, NodeData_, State::max_no_moves>;
+    };
+
+    struct Compact {
+        static constexpr bool struct_of_arrays = false;
+        template<typename State>
+        using node_data = CompactNodeData<State>;
+        template<typename State, typename NodeData_, typename ArcData_ = ArcData<State>>
+        using tree = bt::BlockTree<ArcData_, NodeData_, State::max_no_moves>;
+    };
+
+
+    // The statistics the selection runs on, the third template parameter of
+    // Mcts. With NodeStatistics (UCT1) a child is scored on its node record,
+    // a transposition shares its visits and score among all of its parents.
+    // The arc modes keep the visits and score per arc as well (ArcStatsData)
+    // and explore on the arc visits, i.e. on the count of the move in this
+    // parent. ArcUCT3 exploits the value backed up into the arc: the mean of
+    // the values of the out-arcs of the target, weighted by their visits, so
+    // that results gathered through another parent of a transposition further
+    // down reach all of its ancestors. ArcMax exploits the mean of either the
+    // arc or the target node, whichever has the most visits.
+
+    struct NodeStatistics {
+        static constexpr bool arcs = false, uct3 = false;
+        template<typename State>
+        using arc_data = ArcData<State>;
+    };
+
+    struct ArcUCT3 {
+        static constexpr bool arcs = true, uct3 = true;
+        template<typename State>
+        using arc_data = ArcStatsData<State>;
+    };
+
+    struct ArcMax {
+        static constexpr bool arcs = true, uct3 = false;
+        template<typename State>
+        using arc_data = ArcStatsData<State>;
+    };
 
 
     template <typename State>
@@ -303,19 +582,142 @@ namespace mcts {
     using ArcID = typename Tree<State>::ArcID;
 
 
-    template < typename State >
+    struct SearchStats {
+
+        index_t no_threads = 1;
+        std::int64_t iterations = 0;
+        float seconds = 0.0f, iterations_per_second = 0.0f, speedup = 0.0f;
+        float overshoot = 0.0f; // Seconds past the deadline (of a timed budget).
+        bool over_budget = false; // Eviction could not bring the tree down to the memory budget.
+
+        void print ( const char * name_ ) const noexcept {
+            char speedup_string [ 16 ] = "n/a";
+            if ( speedup > 0.0f ) {
+                std::snprintf ( speedup_string, sizeof ( speedup_string ), "%.2fx", speedup );
+            }
+            std::printf ( " %s, %i threads: %lli iterations in %.3f s, %.0f iterations/s, speedup %s, overshoot %.1f ms%s\n", name_, no_threads, ( long long ) iterations, seconds, iterations_per_second, speedup_string, 1e3f * overshoot, over_budget ? " (over budget)" : "" );
+        }
+    };
+
+
+    class CancellationToken {
+
+        std::atomic<bool> m_cancelled { false };
+
+    public:
+
+        void cancel ( ) noexcept {
+            m_cancelled.store ( true, std::memory_order_relaxed );
+        }
+
+        void reset ( ) noexcept {
+            m_cancelled.store ( false, std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] bool cancelled ( ) const noexcept {
+            return m_cancelled.load ( std::memory_order_relaxed );
+        }
+    };
+
+
+    using Clock = std::chrono::steady_clock;
+
+    // The budget of a compute, whichever of the iterations, the deadline or the
+    // cancellation token runs out first.
+
+    struct Budget {
+
+        std::int64_t max_iterations = std::numeric_limits<index_t>::max ( );
+        Clock::time_point deadline = Clock::time_point::max ( );
+        const CancellationToken * token = nullptr;
+
+        [[ nodiscard ]] static Budget iterations ( const index_t max_iterations_ ) noexcept {
+            Budget budget;
+            budget.max_iterations = max_iterations_;
+            return budget;
+        }
+
+        template<typename Rep, typename Period>
+        [[ nodiscard ]] static Budget time ( const std::chrono::duration<Rep, Period> duration_, const CancellationToken * token_ = nullptr ) noexcept {
+            Budget budget;
+            budget.deadline = Clock::now ( ) + std::chrono::duration_cast<Clock::duration> ( duration_ );
+            budget.token = token_;
+            return budget;
+        }
+
+        [[ nodiscard ]] bool timed ( ) const noexcept {
+            return Clock::time_point::max ( ) != deadline;
+        }
+
+        [[ nodiscard ]] bool cancelled ( ) const noexcept {
+            return nullptr != token and token->cancelled ( );
+        }
+    };
+
+
+    // The summed results of a batch of rollouts, from either players' perspective.
+
+    struct Rollouts {
+
+        float agent_score = 0.0f, human_score = 0.0f;
+        std::int32_t no_rollouts = 0;
+
+        template<typename State>
+        void add ( const State & state_ ) noexcept {
+            agent_score += state_.result ( Player::Type::agent );
+            human_score += state_.result ( Player::Type::human );
+            ++no_rollouts;
+        }
+
+        // A rollout won by winner_ (vacant for a draw), scored as State::result ( ... )
+        // does, i.e. an undetermined (invalid) winner is a loss to both players.
+
+        void add ( const Player winner_ ) noexcept {
+            if ( not ( winner_.vacant ( ) ) ) {
+                agent_score += winner_.agent ( ) ? 1.0f : -1.0f;
+                human_score += winner_ == Player::Type::human ? 1.0f : -1.0f;
+            }
+            ++no_rollouts;
+        }
+
+        // The score from the perspective of player_just_moved_. A node without a
+        // player that just moved (invalid, a record never given a state) has no
+        // perspective, it's not scored.
+
+        [[ nodiscard ]] float score ( const Player player_just_moved_ ) const noexcept {
+            if ( player_just_moved_.agent ( ) ) {
+                return agent_score;
+            }
+            if ( player_just_moved_.human ( ) ) {
+                return human_score;
+            }
+            return 0.0f;
+        }
+
+        [[ maybe_unused ]] Rollouts & operator += ( const Rollouts & rhs_ ) noexcept {
+            agent_score += rhs_.agent_score;
+            human_score += rhs_.human_score;
+            no_rollouts += rhs_.no_rollouts;
+            return * this;
+        }
+    };
+
+
+    template < typename State, typename Layout = ArrayOfStructs, typename Statistics = NodeStatistics >
     class Mcts {
 
     public:
 
-        using Tree = Tree<State>;
+        using NodeData = typename Layout::template node_data<State>;
+        using ArcData = typename Statistics::template arc_data<State>;
+        using Tree = typename Layout::template tree<State, NodeData, ArcData>;
+
+        static_assert ( not ( std::is_same_v<NodeData, CompactNodeData<State>> ) or 12u == sizeof ( NodeData ), "the compact node record is 12 bytes" );
+        static_assert ( not ( std::is_same_v<ArcData, ArcStatsData<State>> ) or ( sizeof ( typename State::Move ) + 3u ) / 4u * 4u + 8u == sizeof ( ArcData ), "the arc statistics record is the move (padded to 4 bytes) and 8 bytes" );
 
         using ArcID = typename Tree::ArcID;
         using NodeID = typename Tree::NodeID;
 
-        using ArcData = ArcData<State>;
-        using NodeData = NodeData<State>;
-
         using InIt = typename Tree::in_iterator;
         using OutIt = typename Tree::out_iterator;
 
@@ -330,7 +732,7 @@ namespace mcts {
         using Link = typename Tree::Link;
         using Path = typename Tree::Path;
 
-        using TranspositionTable = std::unordered_map<ZobristHash, NodeID>;
+        using TranspositionTable = tt::TranspositionTable<ZobristHash, NodeID>;
         using InverseTranspositionTable = std::vector < ZobristHash >;
         using TranspositionTablePtr = llvm::OwningPtr<TranspositionTable>;
 
@@ -338,6 +740,7 @@ namespace mcts {
 
         Tree m_tree;
         TranspositionTablePtr m_transposition_table;
+        NodeStats m_stats; // The statistics, with the StructOfArrays layout only.
 
         bool m_not_initialized = true;
 
@@ -350,16 +753,227 @@ namespace mcts {
         Path m_path;
         index_t m_path_size;
 
+        // Statistics of the last compute. The speedup is relative to the
+        // throughput of a serial compute of the same position, as measured by
+        // measureSerialBaseline ( ... ) (or as set), 0 (n/a) without a baseline.
+
+        SearchStats m_search_stats;
+        float m_serial_iterations_per_second = 0.0f;
+
+        void setSerialBaseline ( const float iterations_per_second_ ) noexcept {
+            m_serial_iterations_per_second = iterations_per_second_;
+        }
+
+        // Times a serial compute of state_ within budget_ (a timed budget_ should
+        // not have expired) on a fresh instance with the settings of this one,
+        // this instance is left as is.
+
+        void measureSerialBaseline ( const State & state_, const Budget & budget_ ) noexcept {
+            Mcts * serial = new Mcts ( );
+            serial->inheritSettings ( * this );
+            serial->m_rng = m_rng.split ( );
+            serial->initialize ( state_ );
+            const Clock::time_point start = Clock::now ( );
+            const std::int64_t iterations = serial->search ( state_, budget_ );
+            const float seconds = std::chrono::duration<float> ( Clock::now ( ) - start ).count ( );
+            m_serial_iterations_per_second = seconds > 0.0f ? ( float ) iterations / seconds : 0.0f;
+            delete serial;
+        }
+
+        // An estimate of the memory held by this instance, in bytes: the node and
+        // arc data with their links and the transposition table. The untried moves
+        // live in the (shared) moves pool and are not accounted for.
+
+        [[ nodiscard ]] std::size_t memory ( ) const noexcept {
+            std::size_t bytes = sizeof ( Mcts ) + m_stats.memory ( );
+            if constexpr ( requires { m_tree.memory ( ); } ) {
+                bytes += m_tree.memory ( );
+            }
+            else {
+                bytes += m_tree.nodesSize ( ) * ( sizeof ( NodeData ) + sizeof ( ArcData ) + 4 * sizeof ( NodeID ) );
+            }
+            if ( nullptr != m_transposition_table.get ( ) ) {
+                bytes += m_transposition_table->memory ( );
+            }
+            return bytes;
+        }
+
+        // The memory budget, in bytes (0 is unbounded), on the live nodes, arcs
+        // and transposition entries. Once a (serial) search exceeds the budget,
+        // the subtrees of least value are evicted, see evict ( ... ), the slots
+        // of the released nodes are reused, i.e. from then on the search runs
+        // at a fixed footprint. Requires a BlockTree (ContiguousChildren or
+        // Compact layout).
+
+        static constexpr bool evictable = requires ( Tree & tree_, NodeID node_ ) { tree_.releaseNode ( node_ ); };
+
+        std::size_t m_memory_budget = 0u;
+        std::int64_t m_no_evicted_nodes = 0;
+        std::size_t m_evict_unmet_at = 0u; // The nodeNum ( ) at the last eviction that fell short of the budget, 0 if none.
+
+        // After an eviction fell short (everything left is on the m_path or
+        // above the threshold), the next one waits until the tree has grown by
+        // an eighth, instead of walking the tree every iteration.
+
+        [[ nodiscard ]] bool evictionDue ( ) const noexcept {
+            return m_memory_budget and liveMemory ( ) > m_memory_budget and m_tree.nodeNum ( ) > m_evict_unmet_at + m_evict_unmet_at / 8u;
+        }
+
+        void setMemoryBudget ( const std::size_t bytes_ ) noexcept {
+            static_assert ( evictable, "a memory budget requires a tree that releases nodes" );
+            m_memory_budget = bytes_;
+        }
+
+        // Incremental compaction: after prunes and evictions the live nodes are
+        // scattered over the slots. A compaction pass walks the tree depth first
+        // from the root_node and moves each node into the lowest free slot, the
+        // children of a node one after the other, i.e. next to each other, and
+        // its block into the lowest free block, fixing up the arc into the node
+        // and its transposition entry. A pass runs in slices of (the children of)
+        // m_compaction_slice nodes, between the iterations of a (serial) search,
+        // and starts after a prune or an eviction, if an eighth of the node slots
+        // is free. The nodes on the m_path (but the root_node), and nodes with
+        // more than one parent, are not moved. Requires a BlockTree.
+
+        index_t m_compaction_slice = 0; // Off.
+        bool m_compaction_due = false;
+        std::vector<std::pair<NodeID, State>> m_compaction_stack;
+        boost::dynamic_bitset<> m_compaction_visited;
+
+        void setCompaction ( const index_t slice_ ) noexcept {
+            static_assert ( evictable, "compaction requires a tree that releases nodes" );
+            m_compaction_slice = slice_;
+        }
+
+        // The bytes held by the live nodes and arcs, and by the transposition
+        // table.
+
+        [[ nodiscard ]] std::size_t liveMemory ( ) const noexcept {
+            return m_tree.liveMemory ( ) + m_transposition_table->memory ( );
+        }
+
+        // The size of the transposition table, in bytes, fixed for the session
+        // (the table is carried over on prune ( ... )). Under a memory budget, the
+        // table takes a quarter of the budget at most.
+
+        std::size_t m_transposition_table_bytes = TranspositionTable::default_bytes;
+
+        void setTranspositionTable ( const std::size_t bytes_ ) noexcept {
+            m_transposition_table_bytes = bytes_;
+        }
+
+        [[ nodiscard ]] std::size_t transpositionTableBytes ( ) const noexcept {
+            return m_memory_budget ? std::min ( m_transposition_table_bytes, m_memory_budget / 4u ) : m_transposition_table_bytes;
+        }
+
+        // A prune moves the transposition table to a new generation, the entries
+        // of the older generations are validated as lookups meet them (see
+        // validTransposition ( ... )). After an in-place prune, m_released_in
+        // holds, by slot, the generation in which the slot was last released by
+        // a prune. After a copying prune, m_renumbered holds the new NodeID's by
+        // old NodeID (of the entries of the previous generation), the entries
+        // of before m_renumbered_in are stale.
+
+        std::vector<std::uint8_t> m_released_in;
+        typename Tree::Visited m_renumbered;
+        std::uint8_t m_renumbered_in = 0u;
+
+        // Leaf parallelization: m_no_rollouts rollouts are played out from each
+        // new leaf, spread over the m_rollout_pool (if set), and their summed
+        // results are backpropagated in one pass. For a State with batch
+        // playouts, a multiple of State::batch_size (per task) fills every lane.
+
+        index_t m_no_rollouts = 3;
+        tp::ThreadPool * m_rollout_pool = nullptr;
+
+        void setLeafParallel ( const index_t no_rollouts_, tp::ThreadPool * rollout_pool_ = nullptr ) noexcept {
+            m_no_rollouts = std::max ( no_rollouts_, index_t { 1 } );
+            m_rollout_pool = rollout_pool_;
+        }
+
+        // An optional cache of rollout statistics by position, shared with other
+        // instances (not owned). A new leaf of which the cache holds at least
+        // m_position_cache_visits rollouts backpropagates the cached mean (over
+        // m_no_rollouts visits) instead of rolling out, otherwise its rollouts
+        // are added to the cache. The nodes of the Compact layout hold integer
+        // scores, for these the cached mean is rounded, see simulate ( ... ).
+
+        static constexpr bool integer_scores = requires { requires std::is_integral_v<decltype ( NodeData::m_score )>; };
+
+        pc::PositionCache * m_position_cache = nullptr;
+        std::int32_t m_position_cache_visits = 16;
+
+        void setPositionCache ( pc::PositionCache * position_cache_, const std::int32_t min_visits_ = 16 ) noexcept {
+            m_position_cache = position_cache_;
+            m_position_cache_visits = std::max ( min_visits_, std::int32_t { 1 } );
+        }
+
+        // Settings are carried over to the new instance on prune ( ... ), and to
+        // the worker trees of a root-parallel compute.
+        void inheritSettings ( const Mcts & mcts_ ) noexcept {
+            m_no_rollouts = mcts_.m_no_rollouts;
+            m_rollout_pool = mcts_.m_rollout_pool;
+            m_position_cache = mcts_.m_position_cache;
+            m_position_cache_visits = mcts_.m_position_cache_visits;
+            m_clock_check_interval = mcts_.m_clock_check_interval;
+            m_pinning = mcts_.m_pinning;
+            m_memory_budget = mcts_.m_memory_budget;
+            m_transposition_table_bytes = mcts_.m_transposition_table_bytes;
+            m_compaction_slice = mcts_.m_compaction_slice;
+            m_serial_iterations_per_second = mcts_.m_serial_iterations_per_second;
+            m_rng = mcts_.m_rng;
+        }
+
+        // The threads of a parallel compute (not the calling thread) are pinned to
+        // the cores as per m_pinning.
+
+        topo::Pinning m_pinning = topo::Pinning::none;
+
+        void setPinning ( const topo::Pinning pinning_ ) noexcept {
+            m_pinning = pinning_;
+        }
+
+        // The duration of the merge of the last root-parallel compute, the trees
+        // of a timed root-parallel compute stop growing this much earlier.
+
+        Clock::duration m_merge_duration = Clock::duration::zero ( );
+
+        // With a timed budget, the clock is read every m_clock_check_interval iterations.
+
+        index_t m_clock_check_interval = 32;
+
+        // The random number stream of this instance, split off from the (thread-
+        // local) g_rng on construction. Parallel searches split one stream off per
+        // thread, i.e. a run is reproducible given the seed of g_rng.
+
+        rng_t m_rng { g_rng.split ( ) };
+
+        void seed ( const std::uint64_t seed_ ) noexcept {
+            m_rng.seed ( seed_ );
+        }
+
+        // Pondering, the search continues in the background on the opponents' time.
+
+        std::thread m_ponder_thread;
+        CancellationToken m_ponder_token;
+
+        Mcts ( ) noexcept { }
+
+        ~Mcts ( ) noexcept {
+            stopPondering ( );
+        }
+
         // Init.
 
         void initialize ( const State & state_ ) noexcept {
             if ( m_transposition_table.get ( ) == nullptr ) {
-                m_transposition_table.reset ( new TranspositionTable ( ) );
+                m_transposition_table.reset ( new TranspositionTable ( Tree::NodeID::invalid, transpositionTableBytes ( ) ) );
             }
             // Set root_node data.
             m_tree [ m_tree.root_node ] = NodeData { state_ };
+            emplaceStats ( m_tree.root_node, state_ );
             // Add root_node to transposition_table.
-            m_transposition_table->emplace ( state_.zobrist ( ), m_tree.root_node );
+            insertTransposition ( state_.zobrist ( ), m_tree.root_node );
             // Has been initialized.
             m_not_initialized = false;
             m_path.reset ( Tree::ArcID::invalid, m_tree.root_node );
@@ -373,74 +987,213 @@ namespace mcts {
 
         [[ nodiscard ]] Link addNode ( const NodeID parent_, const State & state_ ) noexcept {
             const Link link_to_child { addArc ( parent_, m_tree.addNode ( state_ ), state_ ) };
-            m_transposition_table->emplace ( state_.zobrist ( ), link_to_child.target );
+            emplaceStats ( link_to_child.target, state_ );
+            insertTransposition ( state_.zobrist ( ), link_to_child.target );
             return link_to_child;
         }
 
+        // A full bucket of the transposition table gives up the entry of the least
+        // visited node (a stale entry first).
+
+        void insertTransposition ( const ZobristHash zobrist_, const NodeID node_ ) noexcept {
+            ( void ) m_transposition_table->insert ( zobrist_, node_, [ this ] ( const NodeID n_ ) { return visits ( n_ ); }, transpositionValidator ( ) );
+        }
+
+        // Whether the entry of node_, of a generation_ before the current one,
+        // still holds, node_ is renumbered after a copying prune.
+
+        [[ nodiscard ]] bool validTransposition ( NodeID & node_, const std::uint8_t generation_ ) const noexcept {
+            if ( m_renumbered.size ( ) ) {
+                if ( m_renumbered_in != generation_ + 1u or m_renumbered.size ( ) <= ( std::size_t ) node_.value ) {
+                    return false;
+                }
+                node_ = m_renumbered [ node_.value ];
+                return Tree::NodeID::invalid != node_;
+            }
+            return generation_ >= m_renumbered_in and ( m_released_in.size ( ) <= ( std::size_t ) node_.value or m_released_in [ node_.value ] <= generation_ );
+        }
+
+        [[ nodiscard ]] auto transpositionValidator ( ) const noexcept {
+            return [ this ] ( NodeID & node_, const std::uint8_t generation_ ) { return validTransposition ( node_, generation_ ); };
+        }
+
+        // Moves the transposition table to a new generation, returns it. On a wrap
+        // the table is cleared, and so is the validation state.
+
+        std::uint8_t nextTranspositionGeneration ( ) noexcept {
+            const std::uint8_t generation = m_transposition_table->nextGeneration ( );
+            if ( 0u == generation ) {
+                m_released_in.clear ( );
+                m_renumbered.clear ( );
+                m_renumbered_in = 0u;
+            }
+            return generation;
+        }
+
 
         void printMoves ( const NodeID n_ ) const noexcept {
             std::cout << "moves of " << ( int ) n_ << ": ";
             for ( OutIt a ( m_tree, n_ ); a != OutIt::end ( ); ++a ) {
                 std::cout << "[" << ( int ) a.get ( ) << ", " << ( int ) m_tree [ a ].m_move.m_loc << "]";
             }
-            putchar ( '\n' );
+            putchar ( '\n' );
+        }
+
+
+        [[ nodiscard ]] Move getMove ( const ArcID arc_ ) const noexcept {
+            return m_tree [ arc_ ].m_move;
+        }
+
+        [[ nodiscard ]] NodeID getNode ( const ZobristHash zobrist_ ) const noexcept {
+            return m_transposition_table->find ( zobrist_, transpositionValidator ( ) );
+        }
+
+        // The arc of move_ out of parent_, ArcID::invalid if there is none.
+        [[ nodiscard ]] Link childByMove ( const NodeID parent_, const Move move_ ) const noexcept {
+            for ( cOutIt a = m_tree.cbeginOut ( parent_ ); a.is_valid ( ); ++a ) {
+                if ( move_ == m_tree [ a ].m_move ) {
+                    return m_tree.link ( a );
+                }
+            }
+            return Link { Tree::ArcID::invalid, Tree::NodeID::invalid };
+        }
+
+
+        [[ nodiscard ]] bool hasChildren ( const NodeID node_ ) const noexcept {
+            return m_tree.isInternal ( node_ );
+        }
+
+
+        // Moves.
+
+        [[ nodiscard ]] bool hasNoUntriedMoves ( const NodeID node_ ) const noexcept {
+            return not ( m_tree [ node_ ].hasUntriedMoves ( ) );
+        }
+
+        [[ nodiscard ]] bool hasUntriedMoves ( const NodeID node_ ) const noexcept {
+            return m_tree [ node_ ].hasUntriedMoves ( );
+        }
+
+        // The state_ is the state of node_.
+
+        [[ nodiscard ]] Move getUntriedMove ( const NodeID node_, const State & state_, rng_t & rng_ ) noexcept {
+            return m_tree [ node_ ].getUntriedMove ( state_, rng_ );
+        }
+
+
+        // Statistics, in the node records or in m_stats, as per the Layout.
+
+        [[ nodiscard ]] std::int32_t visits ( const NodeID node_ ) const noexcept {
+            if constexpr ( Layout::struct_of_arrays ) {
+                return m_stats.visits ( node_.value );
+            }
+            else {
+                return m_tree [ node_ ].visits ( );
+            }
+        }
+
+        [[ nodiscard ]] float score ( const NodeID node_ ) const noexcept {
+            if constexpr ( Layout::struct_of_arrays ) {
+                return m_stats.score ( node_.value );
+            }
+            else {
+                return m_tree [ node_ ].score ( );
+            }
+        }
+
+        [[ nodiscard ]] Player playerJustMoved ( const NodeID node_ ) const noexcept {
+            if constexpr ( Layout::struct_of_arrays ) {
+                return m_stats.playerJustMoved ( node_.value );
+            }
+            else {
+                return m_tree [ node_ ].playerJustMoved ( );
+            }
         }
 
-
-        [[ nodiscard ]] Move getMove ( const ArcID arc_ ) const noexcept {
-            return m_tree [ arc_ ].m_move;
+        void addStats ( const NodeID node_, const float score_, const std::int32_t visits_ ) noexcept {
+            if constexpr ( Layout::struct_of_arrays ) {
+                m_stats.add ( node_.value, score_, visits_ );
+            }
+            else {
+                m_tree [ node_ ].add ( score_, visits_ );
+            }
         }
 
-        [[ nodiscard ]] NodeID getNode ( const ZobristHash zobrist_ ) const noexcept {
-            const auto it = m_transposition_table->find ( zobrist_ );
-            return it == m_transposition_table->cend ( ) ? Tree::NodeID::invalid : it->second;
+        void atomicAddStats ( const NodeID node_, const float score_, const std::int32_t visits_ ) noexcept {
+            if constexpr ( Layout::struct_of_arrays ) {
+                m_stats.atomicAdd ( node_.value, score_, visits_ );
+            }
+            else {
+                m_tree [ node_ ].atomicAdd ( score_, visits_ );
+            }
         }
 
+        // A new node, the node records initialize their statistics on construction.
 
-        [[ nodiscard ]] bool hasChildren ( const NodeID node_ ) const noexcept {
-            return m_tree.isInternal ( node_ );
+        void emplaceStats ( const NodeID node_, const State & state_ ) {
+            if constexpr ( Layout::struct_of_arrays ) {
+                m_stats.emplace ( node_.value, state_.playerJustMoved ( ) );
+            }
         }
 
+        // Arc statistics, with the arc modes of the Statistics only.
 
-        // Moves.
-
-        [[ nodiscard ]] bool hasNoUntriedMoves ( const NodeID node_ ) const noexcept {
-            return m_tree [ node_ ].m_moves == nullptr;
+        [[ nodiscard ]] std::int32_t arcVisits ( const ArcID arc_ ) const noexcept {
+            return m_tree [ arc_ ].visits ( );
         }
 
-        [[ nodiscard ]] bool hasUntriedMoves ( const NodeID node_ ) const noexcept {
-            return m_tree [ node_ ].m_moves != nullptr;
-        }
+        // The score the selection exploits on the arc of link_, in units of the
+        // arc visits (the mean times the arc visits).
 
-        [[ nodiscard ]] Move getUntriedMove ( const NodeID node_ ) noexcept {
-            return m_tree [ node_ ].getUntriedMove ( );
+        [[ nodiscard ]] float arcScore ( const Link & link_ ) const noexcept {
+            const ArcData & data = m_tree [ link_.arc ];
+            if constexpr ( not ( Statistics::uct3 ) ) {
+                const std::int32_t node_visits = visits ( link_.target );
+                if ( node_visits > data.visits ( ) ) {
+                    return score ( link_.target ) * ( float ) data.visits ( ) / ( float ) node_visits;
+                }
+            }
+            return data.score ( );
         }
 
+        // The UCT3 value of node_ (to the player just moved in node_), the mean
+        // of the values of its out-arcs weighted by their visits, or the mean of
+        // its own playouts while none of its out-arcs has been visited.
 
-        // Data.
-
-        [[ nodiscard ]] std::int32_t getVisits ( const NodeID node_ ) const noexcept {
-            std::int32_t visits = 0;
-            for ( InIt a { m_tree, node_ }; a.is_valid ( ); ++a ) {
-                visits += m_tree [ a ].m_visits;
+        [[ nodiscard ]] float backedUpValue ( const NodeID node_ ) const noexcept {
+            const Player player = playerJustMoved ( node_ );
+            float value = 0.0f;
+            std::int32_t arc_visits = 0;
+            for ( cOutIt a = m_tree.cbeginOut ( node_ ); a.is_valid ( ); ++a ) {
+                const Link child = m_tree.link ( a );
+                const float child_score = m_tree [ child.arc ].score ( );
+                value += player == playerJustMoved ( child.target ) ? child_score : -child_score;
+                arc_visits += arcVisits ( child.arc );
             }
-            return visits;
+            return arc_visits > 0 ? value / ( float ) arc_visits : score ( node_ ) / ( float ) visits ( node_ );
         }
 
+        // Updates the arc of link_ (if any), after its target, with ArcUCT3 the
+        // arc takes the value backed up into the target, i.e. the path is to be
+        // updated bottom up.
 
-        [[ nodiscard ]] float getUCTFromArcs ( const NodeID parent_, const NodeID child_ ) const noexcept {
-            ArcData child_data;
-            for ( InIt a { m_tree, child_ }; a.is_valid ( ); ++a ) {
-                child_data += m_tree [ a ];
-            }
-            std::int32_t visits = 1;
-            for ( InIt a { m_tree, parent_ }; a.is_valid ( ); ++a ) {
-                visits += m_tree [ a ].m_visits;
+        template<bool Atomic = false>
+        void addArcStats ( const Link & link_, const float score_, const std::int32_t visits_ ) noexcept {
+            if constexpr ( Statistics::arcs ) {
+                if ( Tree::ArcID::invalid == link_.arc ) {
+                    return;
+                }
+                ArcData & data = m_tree [ link_.arc ];
+                if constexpr ( Atomic ) {
+                    data.atomicAdd ( score_, visits_ );
+                }
+                else {
+                    data.add ( score_, visits_ );
+                }
+                if constexpr ( Statistics::uct3 ) {
+                    data.assignValue ( backedUpValue ( link_.target ) );
+                }
             }
-            //                              Exploitation                                                             Exploration
-            // Exploitation is the task to select the move that leads to the best results so far.
-            // Exploration deals with less promising moves that still have to be examined, due to the uncertainty of the evaluation.
-            return ( float ) child_data.m_score / ( float ) child_data.m_visits + sqrtf ( 3.0f * logf ( ( float ) visits ) / ( float ) child_data.m_visits );
         }
 
 
@@ -448,38 +1201,52 @@ namespace mcts {
             //                              Exploitation                                                             Exploration
             // Exploitation is the task to select the move that leads to the best results so far.
             // Exploration deals with less promising moves that still have to be examined, due to the uncertainty of the evaluation.
-            return ( float ) m_tree [ child_ ].m_score / ( float ) m_tree [ child_ ].m_visits + sqrtf ( 4.0f * logf ( ( float ) ( m_tree [ parent_ ].m_visits + 1 ) ) / ( float ) m_tree [ child_ ].m_visits );
+            const std::int32_t child_visits = visits ( child_ );
+            return score ( child_ ) / ( float ) child_visits + sqrtf ( 4.0f * logf ( ( float ) ( visits ( parent_ ) + 1 ) ) / ( float ) child_visits );
         }
 
 
-        [[ nodiscard ]] Link selectChildRandom ( const NodeID parent_ ) const noexcept {
+        [[ nodiscard ]] Link selectChildRandom ( const NodeID parent_, rng_t & rng_ ) const noexcept {
             boost::container::static_vector<Link, State::max_no_moves> children;
             for ( OutIt a ( m_tree, parent_ ); a.is_valid ( ); ++a ) {
                 children.emplace_back ( a.id ( ), a->target );
             }
-            return children [ std::uniform_int_distribution<ptrdiff_t> ( 0, children.size ( ) - 1 ) ( g_rng ) ];
+            return children [ std::uniform_int_distribution<ptrdiff_t> ( 0, children.size ( ) - 1 ) ( rng_ ) ];
         }
 
 
-        [[ nodiscard ]] Link selectChildUCT ( const NodeID parent_ ) const noexcept {
-            cOutIt a = m_tree.cbeginOut ( parent_ );
-            boost::container::static_vector < Link, State::max_no_moves > best_children ( 1, m_tree.link ( a ) );
-            float best_UCT_score = getUCTFromNode ( parent_, best_children.back ( ).target );
-            ++a;
-            for ( ; a.is_valid ( ); ++a ) {
+        // The visits and scores of the children are gathered, after which the UCT
+        // scores and their argmax are computed in one pass (vectorized, see
+        // uct_simd.hpp), ties are broken by fair coin flips. With the arc modes
+        // the parent visits are the sum of the visits of its out-arcs.
+        [[ nodiscard ]] Link selectChildUCT ( const NodeID parent_, rng_t & rng_ ) const noexcept {
+            static_assert ( State::max_no_moves <= 512, "the selection kernel handles up to 512 children" );
+            constexpr std::size_t capacity = uct::padded ( State::max_no_moves );
+            boost::container::static_vector<Link, State::max_no_moves> children;
+            alignas ( 32 ) std::int32_t child_visits [ capacity ];
+            alignas ( 32 ) float child_scores [ capacity ];
+            std::int32_t parent_visits = 0;
+            for ( cOutIt a = m_tree.cbeginOut ( parent_ ); a.is_valid ( ); ++a ) {
                 const Link child = m_tree.link ( a );
-                const float UCT_score = getUCTFromNode ( parent_, child.target );
-                if ( UCT_score > best_UCT_score ) {
-                    best_children.resize ( 1 );
-                    best_children.back ( ) = child;
-                    best_UCT_score = UCT_score;
+                if constexpr ( Statistics::arcs ) {
+                    child_visits [ children.size ( ) ] = arcVisits ( child.arc );
+                    child_scores [ children.size ( ) ] = arcScore ( child );
+                    parent_visits += child_visits [ children.size ( ) ];
                 }
-                else if ( UCT_score == best_UCT_score ) {
-                    best_children.push_back ( child );
+                else {
+                    child_visits [ children.size ( ) ] = visits ( child.target );
+                    child_scores [ children.size ( ) ] = score ( child.target );
                 }
+                children.push_back ( child );
+            }
+            for ( std::size_t i = children.size ( ); i < uct::padded ( children.size ( ) ); ++i ) {
+                child_visits [ i ] = 1;
+                child_scores [ i ] = 0.0f;
+            }
+            if constexpr ( not ( Statistics::arcs ) ) {
+                parent_visits = visits ( parent_ );
             }
-            // Ties are broken by fair coin flips.
-            return best_children.size ( ) == 1 ? best_children.back ( ) : best_children [ std::uniform_int_distribution < ptrdiff_t > ( 0, best_children.size ( ) - 1 ) ( g_rng ) ];
+            return children [ uct::select ( child_visits, child_scores, children.size ( ), parent_visits, rng_ ) ];
         }
 
 
@@ -490,12 +1257,88 @@ namespace mcts {
         }
 
 
-        void updateData ( const Link & link_, const State & state_ ) noexcept {
-            const float result = state_.result ( m_tree [ link_.target ].m_player_just_moved );
-            // ++m_tree [ link_.arc ].m_visits;
-            // m_tree [ link_.arc ].m_score += result;
-            ++m_tree [ link_.target ].m_visits;
-            m_tree [ link_.target ].m_score += result;
+        // A State with (fast) batch playouts plays out State::batch_size games
+        // per call, the remainder is played out a game at a time.
+        [[ nodiscard ]] static Rollouts playouts ( const State & state_, index_t no_rollouts_, rng_t & rng_ ) noexcept {
+            Rollouts rollouts;
+            if constexpr ( requires { requires State::batch_playouts; } ) {
+                Player winners [ State::batch_size ];
+                for ( ; no_rollouts_ >= ( index_t ) State::batch_size; no_rollouts_ -= ( index_t ) State::batch_size ) {
+                    state_.simulate ( rng_, winners );
+                    for ( const Player winner : winners ) {
+                        rollouts.add ( winner );
+                    }
+                }
+            }
+            while ( no_rollouts_-- > 0 ) {
+                State sim_state ( state_ );
+                sim_state.simulate ( rng_ );
+                rollouts.add ( sim_state );
+            }
+            return rollouts;
+        }
+
+
+        // The rollouts of the new leaf of state_, from the position cache (if set
+        // and holding enough rollouts) or played out.
+        [[ nodiscard ]] Rollouts simulate ( const State & state_, rng_t & rng_ ) const noexcept {
+            if ( nullptr == m_position_cache ) {
+                return rollOut ( state_, rng_ );
+            }
+            const Player player = state_.playerJustMoved ( );
+            const pc::PositionCache::Stats cached = m_position_cache->find ( state_.zobrist ( ), player );
+            if ( cached.visits >= m_position_cache_visits ) {
+                float score = cached.score * ( float ) m_no_rollouts / ( float ) cached.visits;
+                if constexpr ( integer_scores ) {
+                    // The nodes hold integer scores, the prior is rounded once, here,
+                    // and the remainder (in [ -0.5, 0.5 )) is carried over to the next
+                    // hit (of this thread), i.e. the roundings don't add up to a bias,
+                    // and an integer mean is backed up as is.
+                    static thread_local float remainder = 0.0f;
+                    score += remainder;
+                    const float rounded = std::floor ( score + 0.5f );
+                    remainder = score - rounded;
+                    score = rounded;
+                }
+                return player.agent ( ) ? Rollouts { score, -score, m_no_rollouts } : Rollouts { -score, score, m_no_rollouts };
+            }
+            const Rollouts rollouts = rollOut ( state_, rng_ );
+            m_position_cache->add ( state_.zobrist ( ), player, rollouts.score ( player ), rollouts.no_rollouts );
+            return rollouts;
+        }
+
+        // Plays out m_no_rollouts games from state_, the share of the calling
+        // thread is played out while the pool plays out the remainder. The tasks
+        // get their own stream, split off from rng_. While waiting for the
+        // tasks, the calling thread runs pending tasks of the pool, i.e. the
+        // search may run on the workers of the m_rollout_pool itself (as with
+        // the MatchRunner or the EngineHost) without all of them blocking on
+        // rollouts that are still queued.
+        [[ nodiscard ]] Rollouts rollOut ( const State & state_, rng_t & rng_ ) const noexcept {
+            if ( nullptr == m_rollout_pool or m_no_rollouts < 2 ) {
+                return playouts ( state_, m_no_rollouts, rng_ );
+            }
+            const index_t no_tasks = std::min ( m_no_rollouts, m_rollout_pool->size ( ) + 1 );
+            std::vector<std::future<Rollouts>> futures;
+            futures.reserve ( no_tasks - 1 );
+            for ( index_t t = 1; t < no_tasks; ++t ) {
+                const index_t no_rollouts = ( m_no_rollouts * ( t + 1 ) ) / no_tasks - ( m_no_rollouts * t ) / no_tasks;
+                futures.push_back ( m_rollout_pool->submit ( [ & state_, no_rollouts, rng = rng_.split ( ) ] ( ) mutable { return playouts ( state_, no_rollouts, rng ); } ) );
+            }
+            Rollouts rollouts = playouts ( state_, m_no_rollouts / no_tasks, rng_ );
+            for ( std::future<Rollouts> & future : futures ) {
+                while ( std::future_status::ready != future.wait_for ( std::chrono::seconds { 0 } ) and m_rollout_pool->runPending ( ) ) {
+                }
+                rollouts += future.get ( );
+            }
+            return rollouts;
+        }
+
+
+        void updateData ( const Link & link_, const Rollouts & rollouts_ ) noexcept {
+            const float score = rollouts_.score ( playerJustMoved ( link_.target ) );
+            addStats ( link_.target, score, rollouts_.no_rollouts );
+            addArcStats ( link_, score, rollouts_.no_rollouts );
         }
 
 
@@ -507,7 +1350,13 @@ namespace mcts {
             ++m_path_size;
             for ( cOutIt a ( m_tree.cbeginOut ( m_tree.root_node ) ); a.is_valid ( ); ++a ) {
                 const Link child ( m_tree.link ( a ) );
-                const std::int32_t child_visits ( m_tree [ child.target ].m_visits );
+                std::int32_t child_visits;
+                if constexpr ( Statistics::arcs ) {
+                    child_visits = arcVisits ( child.arc );
+                }
+                else {
+                    child_visits = visits ( child.target );
+                }
                 if ( child_visits > best_child_visits ) {
                     best_child_visits = child_visits;
                     best_child_move = m_tree [ child.arc ].m_move;
@@ -520,6 +1369,7 @@ namespace mcts {
 
         // Adding the move of the opponent to the path (and possibly to the tree).
         void connectStatesPath ( const State & state_ ) noexcept {
+            stopPondering ( );
             const NodeID parent = m_path.back ( ).target; NodeID child = getNode ( state_.zobrist ( ) );
             if ( Tree::NodeID::invalid == child ) {
                 child = addNode ( parent, state_ ).target;
@@ -529,89 +1379,527 @@ namespace mcts {
         }
 
 
-        [[ nodiscard ]] Move compute ( const State & state_, index_t max_iterations_ ) noexcept {
+        // One iteration of select, expand, simulate and backpropagate, from root_
+        // (of which the state is state_), path_ is the path up to and including
+        // root_ and is restored to path_size_ links on return.
+        void playout ( const NodeID root_, const State & state_, Path & path_, const index_t path_size_, rng_t & rng_ ) noexcept {
 
             // constexpr std::int32_t threshold = 5;
 
-            if ( m_not_initialized ) {
-                initialize ( state_ );
-            }
-            else {
-                connectStatesPath ( state_ );
-            }
-
             // const Player player = state_.playerToMove ( );
             // if ( player == Player::Type::agent ) {
                 // m_path.print ( );
             // }
 
+            NodeID node = root_;
+            State state ( state_ );
+            // Select a path through the tree to a leaf node.
+            while ( hasNoUntriedMoves ( node ) and hasChildren ( node ) ) {
+                // UCT is only applied in nodes of which the visit count
+                // is higher than a certain threshold T
+                Link child = selectChildUCT ( node, rng_ );
+                state.move_hash ( m_tree [ child.arc ].m_move );
+                path_.push ( child );
+                node = child.target;
+            }
+
+            /*
+
+            static int cnt = 0;
+
+            if ( state != m_tree [ node ].m_state ) {
+                state.print ( );
+                m_tree [ node ].m_state.print ( );
+                ++cnt;
+                if ( cnt == 100 ) exit ( 0 );
+            }
+
+            */
+
+            // If we are not already at the final state, expand the tree with a new
+            // node and move there.
+
+            // In addition to expanding one node per simulated game, we also expand all the
+            // children of a node when a node's visit count equals T
+
+            if ( hasUntriedMoves ( node ) ) {
+                // if ( player == Player::Type::agent and m_tree [ node ].m_visits < threshold )
+                state.move_hash_winner ( getUntriedMove ( node, state, rng_ ) ); // State update.
+                path_.push ( addChild ( node, state ) );
+            }
+
+            // The player in back of path is player ( the player to move ).We now play
+            // randomly until the game ends.
+
+            // if ( player == Player::Type::human ) {
+                // state.simulate ( );
+                // for ( Link & link : path_ ) {
+                    // We have now reached a final state. Backpropagate the result up the
+                    // tree to the root node.
+                    // updateData ( link, state );
+                // }
+            // }
+
+            // else {
+
+            const Rollouts rollouts = simulate ( state, rng_ );
+            // We have now reached the final states. Backpropagate the summed results
+            // up the tree to the root node.
+            for ( auto link = path_.end ( ); link != path_.begin ( ); ) {
+                updateData ( * --link, rollouts );
+            }
+            // }
+            path_.resize ( path_size_ );
+        }
+
+
+        // Runs iterations from the root_node until the budget_ is exhausted,
+        // state_ is the state of the root_node. The clock is only read every
+        // m_clock_check_interval iterations. Returns the number of iterations.
+        [[ maybe_unused ]] std::int64_t search ( const State & state_, const Budget & budget_ ) noexcept {
             // max_iterations_ -= m_tree.nodeNum ( );
+            const bool timed = budget_.timed ( );
+            std::int64_t iterations = 0;
+            while ( iterations < budget_.max_iterations ) {
+                playout ( m_tree.root_node, state_, m_path, m_path_size, m_rng );
+                ++iterations;
+                if constexpr ( evictable ) {
+                    if ( evictionDue ( ) ) {
+                        m_evict_unmet_at = evict ( state_ ) ? 0u : m_tree.nodeNum ( );
+                    }
+                    if ( m_compaction_slice ) {
+                        compact ( state_ );
+                    }
+                }
+                if ( budget_.cancelled ( ) or ( timed and 0 == iterations % m_clock_check_interval and Clock::now ( ) >= budget_.deadline ) ) {
+                    break;
+                }
+            }
+            return iterations;
+        }
+
+
+        // Eviction brings the live memory down to 3/4 of the budget. A node is
+        // evicted by releasing its children, it keeps its statistics and all its
+        // moves are untried again. A child is released with the last arc into it,
+        // recursively, with its transposition entry. The nodes are evicted in
+        // order of visits, the threshold is chosen such that enough nodes have
+        // only parents below it. The nodes on m_path are never evicted.
+        // state_ is the state of the root_node. Returns false if no nodes could
+        // be evicted.
+
+        [[ maybe_unused ]] bool evict ( const State & state_ ) {
+            stopCompaction ( );
+            const std::size_t live_memory = liveMemory ( ), no_nodes = m_tree.nodeNum ( );
+            const std::size_t no_evict = ( live_memory - m_memory_budget * 3u / 4u ) / ( live_memory / no_nodes ) + 1u;
+            boost::dynamic_bitset<> kept ( m_tree.nodesSize ( ) );
+            for ( const Link & link : m_path ) {
+                kept [ link.target.value ] = true;
+            }
+            // The largest visits of the parents of each node.
+            std::vector<std::int32_t> parent_visits ( m_tree.nodesSize ( ), -1 );
+            std::vector<NodeID> stack { m_tree.root_node };
+            parent_visits [ m_tree.root_node.value ] = std::numeric_limits<std::int32_t>::max ( );
+            while ( stack.size ( ) ) {
+                const NodeID parent = stack.back ( ); stack.pop_back ( );
+                const std::int32_t visits = kept [ parent.value ] ? std::numeric_limits<std::int32_t>::max ( ) : this->visits ( parent );
+                for ( cOutIt a = m_tree.cbeginOut ( parent ); a.is_valid ( ); ++a ) {
+                    if ( -1 == parent_visits [ a->target.value ] ) {
+                        stack.push_back ( a->target );
+                    }
+                    parent_visits [ a->target.value ] = std::max ( parent_visits [ a->target.value ], visits );
+                }
+            }
+            parent_visits.erase ( std::remove ( parent_visits.begin ( ), parent_visits.end ( ), -1 ), parent_visits.end ( ) );
+            if ( no_evict >= parent_visits.size ( ) ) {
+                return false;
+            }
+            std::nth_element ( parent_visits.begin ( ), parent_visits.begin ( ) + no_evict, parent_visits.end ( ) );
+            const std::int32_t threshold = parent_visits [ no_evict ];
+            if ( std::numeric_limits<std::int32_t>::max ( ) == threshold ) {
+                return false;
+            }
+            const std::size_t no_nodes_before = m_tree.nodeNum ( );
+            boost::dynamic_bitset<> visited ( m_tree.nodesSize ( ) );
+            evictBelow ( m_tree.root_node, state_, threshold + 1, kept, visited );
+            m_no_evicted_nodes += no_nodes_before - m_tree.nodeNum ( );
+            m_compaction_due = true;
+            return no_nodes_before != m_tree.nodeNum ( );
+        }
+
+        // One slice of a compaction pass, state_ is the state of the root_node.
+
+        void compact ( const State & state_ ) {
+            const auto on_path = [ this ] ( const NodeID node_ ) {
+                for ( const Link & link : m_path ) {
+                    if ( node_ == link.target ) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+            if ( m_compaction_stack.empty ( ) ) {
+                if ( not ( m_compaction_due ) or 8u * ( m_tree.nodesSize ( ) - m_tree.nodeNum ( ) ) < m_tree.nodesSize ( ) ) {
+                    return;
+                }
+                m_compaction_due = false;
+                m_tree.beginCompaction ( );
+                const NodeID root_node = m_tree.root_node;
+                if ( root_node != m_tree.relocateRoot ( ) ) {
+                    ( void ) m_transposition_table->assign ( state_.zobrist ( ), m_tree.root_node );
+                    for ( Link & link : m_path ) {
+                        if ( root_node == link.target ) {
+                            link.target = m_tree.root_node;
+                        }
+                    }
+                }
+                m_compaction_visited.clear ( );
+                m_compaction_visited.resize ( m_tree.nodesSize ( ) );
+                m_compaction_visited [ m_tree.root_node.value ] = true;
+                m_compaction_stack.emplace_back ( m_tree.root_node, state_ );
+            }
+            for ( index_t i = 0; i < m_compaction_slice and m_compaction_stack.size ( ); ++i ) {
+                const std::pair<NodeID, State> parent = std::move ( m_compaction_stack.back ( ) );
+                m_compaction_stack.pop_back ( );
+                if ( not ( on_path ( parent.first ) ) ) {
+                    m_tree.relocateBlock ( parent.first );
+                }
+                for ( OutIt a { m_tree, parent.first }; a.is_valid ( ); ++a ) {
+                    NodeID child = a->target;
+                    if ( ( std::size_t ) child.value < m_compaction_visited.size ( ) and m_compaction_visited [ child.value ] ) {
+                        continue;
+                    }
+                    State state ( parent.second );
+                    state.move_hash_winner ( m_tree [ a ].m_move );
+                    if ( not ( on_path ( child ) ) ) {
+                        const NodeID slot = m_tree.relocate ( a.id ( ) );
+                        if ( slot != child ) {
+                            ( void ) m_transposition_table->assign ( state.zobrist ( ), slot );
+                            child = slot;
+                        }
+                    }
+                    if ( ( std::size_t ) child.value >= m_compaction_visited.size ( ) ) {
+                        m_compaction_visited.resize ( m_tree.nodesSize ( ) );
+                    }
+                    m_compaction_visited [ child.value ] = true;
+                    if ( m_tree.isInternal ( child ) ) {
+                        m_compaction_stack.emplace_back ( child, std::move ( state ) );
+                    }
+                }
+            }
+            if ( m_compaction_stack.empty ( ) ) {
+                m_tree.endCompaction ( );
+            }
+        }
+
+        // Ends a running compaction pass, before the tree is restructured.
+
+        void stopCompaction ( ) {
+            if ( m_compaction_stack.size ( ) ) {
+                m_compaction_stack.clear ( );
+                m_tree.endCompaction ( );
+            }
+        }
+
+        private:
+
+        void evictBelow ( const NodeID node_, const State & state_, const std::int32_t threshold_, const boost::dynamic_bitset<> & kept_, boost::dynamic_bitset<> & visited_ ) {
+            visited_ [ node_.value ] = true;
+            if ( not ( kept_ [ node_.value ] ) and visits ( node_ ) < threshold_ ) {
+                for ( cOutIt a = m_tree.cbeginOut ( node_ ); a.is_valid ( ); ++a ) {
+                    State state ( state_ );
+                    state.move_hash_winner ( m_tree [ a ].m_move );
+                    release ( a->target, state );
+                }
+                m_tree.clearOut ( node_ );
+                m_tree [ node_ ].resetMoves ( state_ );
+                return;
+            }
+            for ( cOutIt a = m_tree.cbeginOut ( node_ ); a.is_valid ( ); ++a ) {
+                if ( not ( visited_ [ a->target.value ] ) ) {
+                    State state ( state_ );
+                    state.move_hash_winner ( m_tree [ a ].m_move );
+                    evictBelow ( a->target, state, threshold_, kept_, visited_ );
+                }
+            }
+        }
+
+        void release ( const NodeID node_, const State & state_ ) {
+            if ( m_tree.releaseIn ( node_ ) ) {
+                for ( cOutIt a = m_tree.cbeginOut ( node_ ); a.is_valid ( ); ++a ) {
+                    State state ( state_ );
+                    state.move_hash_winner ( m_tree [ a ].m_move );
+                    release ( a->target, state );
+                }
+                m_tree.clearOut ( node_ );
+                ( void ) m_transposition_table->erase ( state_.zobrist ( ) );
+                m_tree.releaseNode ( node_ );
+            }
+        }
+
+        public:
 
-            while ( max_iterations_-- > 0 ) {
+
+        static constexpr std::int32_t virtual_loss = 1;
+
+        void addVirtualLoss ( const Link & link_ ) noexcept {
+            atomicAddStats ( link_.target, ( float ) -virtual_loss, virtual_loss );
+            addArcStats<true> ( link_, ( float ) -virtual_loss, virtual_loss );
+        }
+
+
+        // The body of search ( ... ), for threads sharing the tree.
+        [[ maybe_unused ]] std::int64_t searchShared ( const State & state_, const Budget & budget_, std::atomic<std::int64_t> & remaining_iterations_, std::shared_mutex & tree_mutex_, rng_t rng_ ) noexcept {
+            const bool timed = budget_.timed ( );
+            std::int64_t iterations = 0;
+            Path path ( m_path );
+            const index_t path_size = m_path_size;
+            while ( remaining_iterations_.fetch_sub ( 1, std::memory_order_relaxed ) > 0 ) {
                 NodeID node = m_tree.root_node;
                 State state ( state_ );
+                std::shared_lock<std::shared_mutex> shared_lock ( tree_mutex_ );
                 // Select a path through the tree to a leaf node.
                 while ( hasNoUntriedMoves ( node ) and hasChildren ( node ) ) {
-                    // UCT is only applied in nodes of which the visit count
-                    // is higher than a certain threshold T
-                    Link child = selectChildUCT ( node );
+                    const Link child = selectChildUCT ( node, rng_ );
+                    addVirtualLoss ( child );
                     state.move_hash ( m_tree [ child.arc ].m_move );
-                    m_path.push ( child );
+                    path.push ( child );
                     node = child.target;
                 }
+                shared_lock.unlock ( );
+                // Expand, the untried moves are re-checked, another thread might
+                // have taken the last one in the meanwhile.
+                {
+                    std::unique_lock<std::shared_mutex> unique_lock ( tree_mutex_ );
+                    if ( hasUntriedMoves ( node ) ) {
+                        state.move_hash_winner ( getUntriedMove ( node, state, rng_ ) ); // State update.
+                        const Link child = addChild ( node, state );
+                        addVirtualLoss ( child ); // Before other threads can see the node.
+                        path.push ( child );
+                    }
+                }
+                const Rollouts rollouts = simulate ( state, rng_ );
+                // Backpropagate (bottom up), the links beyond path_size carry a virtual loss.
+                shared_lock.lock ( );
+                index_t i = path.size ( );
+                for ( auto l = path.end ( ); l != path.begin ( ); ) {
+                    const Link & link = * --l;
+                    const float score = rollouts.score ( playerJustMoved ( link.target ) );
+                    if ( --i < path_size ) {
+                        atomicAddStats ( link.target, score, rollouts.no_rollouts );
+                        addArcStats<true> ( link, score, rollouts.no_rollouts );
+                    }
+                    else {
+                        atomicAddStats ( link.target, score + ( float ) virtual_loss, rollouts.no_rollouts - virtual_loss );
+                        addArcStats<true> ( link, score + ( float ) virtual_loss, rollouts.no_rollouts - virtual_loss );
+                    }
+                }
+                shared_lock.unlock ( );
+                path.resize ( path_size );
+                ++iterations;
+                if ( budget_.cancelled ( ) or ( timed and 0 == iterations % m_clock_check_interval and Clock::now ( ) >= budget_.deadline ) ) {
+                    break;
+                }
+            }
+            return iterations;
+        }
+
 
-                /*
+        void recordSearchStats ( const index_t no_threads_, const std::int64_t iterations_, const float seconds_, const Budget & budget_ ) noexcept {
+            m_search_stats.no_threads = no_threads_;
+            m_search_stats.iterations = iterations_;
+            m_search_stats.seconds = seconds_;
+            m_search_stats.iterations_per_second = seconds_ > 0.0f ? ( float ) iterations_ / seconds_ : 0.0f;
+            m_search_stats.speedup = m_serial_iterations_per_second > 0.0f ? m_search_stats.iterations_per_second / m_serial_iterations_per_second : 0.0f;
+            m_search_stats.overshoot = budget_.timed ( ) ? std::max ( std::chrono::duration<float> ( Clock::now ( ) - budget_.deadline ).count ( ), 0.0f ) : 0.0f;
+            m_search_stats.over_budget = 0u != m_evict_unmet_at;
+        }
 
-                static int cnt = 0;
 
-                if ( state != m_tree [ node ].m_state ) {
-                    state.print ( );
-                    m_tree [ node ].m_state.print ( );
-                    ++cnt;
-                    if ( cnt == 100 ) exit ( 0 );
-                }
+        [[ nodiscard ]] Move compute ( const State & state_, const Budget & budget_ ) noexcept {
+            stopPondering ( );
+            if ( m_not_initialized ) {
+                initialize ( state_ );
+            }
+            else {
+                connectStatesPath ( state_ );
+            }
+            const Clock::time_point start = Clock::now ( );
+            const std::int64_t iterations = search ( state_, budget_ );
+            recordSearchStats ( 1, iterations, std::chrono::duration<float> ( Clock::now ( ) - start ).count ( ), budget_ );
+            return getBestMove ( );
+        }
 
-                */
+        [[ nodiscard ]] Move compute ( const State & state_, const index_t max_iterations_ ) noexcept {
+            return compute ( state_, Budget::iterations ( max_iterations_ ) );
+        }
+
+        // Returns the best move so far, once the budget_ has run out, or on cancellation.
+        template<typename Rep, typename Period>
+        [[ nodiscard ]] Move compute ( const State & state_, const std::chrono::duration<Rep, Period> budget_, const CancellationToken * token_ = nullptr ) noexcept {
+            return compute ( state_, Budget::time ( budget_, token_ ) );
+        }
 
-                // If we are not already at the final state, expand the tree with a new
-                // node and move there.
+        [[ nodiscard ]] Move compute ( const State & state_, const index_t max_iterations_, const CancellationToken & token_ ) noexcept {
+            Budget budget = Budget::iterations ( max_iterations_ );
+            budget.token = & token_;
+            return compute ( state_, budget );
+        }
 
-                // In addition to expanding one node per simulated game, we also expand all the
-                // children of a node when a node's visit count equals T
 
-                if ( hasUntriedMoves ( node ) ) {
-                    // if ( player == Player::Type::agent and m_tree [ node ].m_visits < threshold )
-                    state.move_hash_winner ( getUntriedMove ( node ) ); // State update.
-                    m_path.push ( addChild ( node, state ) );
+        // Root parallelization: no_threads_ trees are grown independently (one
+        // thread per tree, mcts_ being one of them) from the same root state_, each
+        // within budget_, and are thereafter folded into mcts_ with merge ( ... ).
+        // mcts_ is pruned to state_ first, if required. The merge counts against a
+        // timed budget_: the trees stop growing the (last measured) merge time
+        // before the deadline, and the trees not merged by the deadline are dropped.
+        [[ nodiscard ]] static Move computeRootParallel ( Mcts * & mcts_, const State & state_, const Budget & budget_, const index_t no_threads_ = topo::usableCores ( ) ) noexcept {
+            mcts_->stopPondering ( );
+            if ( not ( mcts_->m_not_initialized ) and mcts_->m_tree.root_node != mcts_->getNode ( state_.zobrist ( ) ) ) {
+                prune ( mcts_, state_ );
+            }
+            if ( mcts_->m_not_initialized ) {
+                mcts_->initialize ( state_ );
+            }
+            const index_t no_threads = std::max ( no_threads_, index_t { 1 } );
+            std::vector<Mcts *> workers ( no_threads - 1 );
+            std::vector<std::int64_t> iterations ( no_threads, 0 );
+            std::vector<std::thread> threads;
+            threads.reserve ( workers.size ( ) );
+            // Before a merge has been timed, a tenth of the time left is set aside.
+            Budget budget = budget_;
+            Clock::duration merge_reserve = Clock::duration::zero ( );
+            if ( budget.timed ( ) and not ( workers.empty ( ) ) ) {
+                merge_reserve = Clock::duration::zero ( ) != mcts_->m_merge_duration ? mcts_->m_merge_duration : ( budget.deadline - Clock::now ( ) ) / 10;
+                budget.deadline -= merge_reserve;
+            }
+            const Clock::time_point start = Clock::now ( );
+            for ( std::size_t i = 0; i < workers.size ( ); ++i ) {
+                Mcts * worker = workers [ i ] = new Mcts ( );
+                worker->inheritSettings ( * mcts_ );
+                worker->m_rng = mcts_->m_rng.split ( );
+                worker->initialize ( state_ );
+                threads.emplace_back ( [ worker, & state_, & budget, & iterations, i ] ( ) {
+                    topo::pin ( ( index_t ) i + 1, worker->m_pinning );
+                    iterations [ i + 1 ] = worker->search ( state_, budget );
+                } );
+            }
+            iterations [ 0 ] = mcts_->search ( state_, budget );
+            for ( std::thread & thread : threads ) {
+                thread.join ( );
+            }
+            const Clock::time_point merge_start = Clock::now ( );
+            const float seconds = std::chrono::duration<float> ( merge_start - start ).count ( );
+            // Fold the trees into mcts_, merge ( ... ) deletes the merged worker (and
+            // may swap mcts_ with it), the trees left at the deadline are deleted.
+            std::size_t no_merged = 0u;
+            for ( Mcts * & worker : workers ) {
+                if ( budget_.timed ( ) and Clock::now ( ) >= budget_.deadline ) {
+                    delete worker;
+                    worker = nullptr;
+                    continue;
                 }
+                merge ( mcts_, worker );
+                ++no_merged;
+            }
+            // Extrapolated to all the trees, if merging was cut short.
+            if ( no_merged ) {
+                mcts_->m_merge_duration = ( Clock::now ( ) - merge_start ) * ( std::int64_t ) workers.size ( ) / ( std::int64_t ) no_merged;
+            }
+            else if ( not ( workers.empty ( ) ) ) {
+                mcts_->m_merge_duration = 2 * merge_reserve;
+            }
+            mcts_->recordSearchStats ( no_threads, std::accumulate ( std::begin ( iterations ), std::end ( iterations ), std::int64_t { 0 } ), seconds, budget_ );
+            return mcts_->getBestMove ( );
+        }
 
-                // The player in back of path is player ( the player to move ).We now play
-                // randomly until the game ends.
+        [[ nodiscard ]] static Move computeRootParallel ( Mcts * & mcts_, const State & state_, const index_t max_iterations_, const index_t no_threads_ = topo::usableCores ( ) ) noexcept {
+            return computeRootParallel ( mcts_, state_, Budget::iterations ( max_iterations_ ), no_threads_ );
+        }
 
-                // if ( player == Player::Type::human ) {
-                    // state.simulate ( );
-                    // for ( Link & link : m_path ) {
-                        // We have now reached a final state. Backpropagate the result up the
-                        // tree to the root node.
-                        // updateData ( link, state );
-                    // }
-                // }
 
-                // else {
+        // Tree parallelization: no_threads_ threads (the calling thread being one
+        // of them) share the budget_ over the one tree. Selection and
+        // backpropagation take the lock shared, expansion takes it exclusive
+        // (the tree is not a concurrent container, the transposition table is
+        // lock-free, but its lookup and insert are part of the expansion).
+        // A virtual loss is applied to every node on the selected path, such
+        // that concurrent selections diverge, it's reverted on backpropagation.
+        [[ nodiscard ]] Move computeTreeParallel ( const State & state_, const Budget & budget_, const index_t no_threads_ = topo::usableCores ( ) ) noexcept {
+            stopPondering ( );
+            if ( m_not_initialized ) {
+                initialize ( state_ );
+            }
+            else {
+                connectStatesPath ( state_ );
+            }
+            const index_t no_threads = std::max ( no_threads_, index_t { 1 } );
+            std::atomic<std::int64_t> remaining_iterations { budget_.max_iterations };
+            std::shared_mutex tree_mutex;
+            std::vector<std::int64_t> iterations ( no_threads, 0 );
+            std::vector<std::thread> threads;
+            threads.reserve ( no_threads - 1 );
+            const Clock::time_point start = Clock::now ( );
+            for ( index_t i = 1; i < no_threads; ++i ) {
+                threads.emplace_back ( [ this, & state_, & budget_, & remaining_iterations, & tree_mutex, & iterations, i, rng = m_rng.split ( ) ] ( ) {
+                    topo::pin ( ( index_t ) i, m_pinning );
+                    iterations [ i ] = searchShared ( state_, budget_, remaining_iterations, tree_mutex, rng );
+                } );
+            }
+            iterations [ 0 ] = searchShared ( state_, budget_, remaining_iterations, tree_mutex, m_rng.split ( ) );
+            for ( std::thread & thread : threads ) {
+                thread.join ( );
+            }
+            recordSearchStats ( no_threads, std::accumulate ( std::begin ( iterations ), std::end ( iterations ), std::int64_t { 0 } ), std::chrono::duration<float> ( Clock::now ( ) - start ).count ( ), budget_ );
+            return getBestMove ( );
+        }
+
+        [[ nodiscard ]] Move computeTreeParallel ( const State & state_, const index_t max_iterations_, const index_t no_threads_ = topo::usableCores ( ) ) noexcept {
+            return computeTreeParallel ( state_, Budget::iterations ( max_iterations_ ), no_threads_ );
+        }
+
 
-                for ( index_t i = 0; i < 3; ++i ) {
-                    State sim_state ( state );
-                    sim_state.simulate ( );
-                    // We have now reached a final state. Backpropagate the result up the
-                    // tree to the root node.
-                    for ( Link & link : m_path ) {
-                        updateData ( link, sim_state );
+        // Keeps searching the tree in a background thread, until stopPondering ( )
+        // is called (by any of compute, prune, reset, merge, connectStatesPath, or
+        // on destruction), or until max_iterations_ iterations have been done.
+        // state_ is the state after the move returned by compute ( ... ), the
+        // search is rooted at the node of state_, i.e. it refines the subtree
+        // (below the opponents' moves) that will be kept by prune ( ... ). The
+        // search does not evict (that requires the state of the root_node), it
+        // stops once the tree reaches the memory budget (if set).
+
+        static constexpr index_t default_ponder_iterations = 1'000'000;
+
+        void startPondering ( const State & state_, const index_t max_iterations_ = default_ponder_iterations ) noexcept {
+            stopPondering ( );
+            const NodeID node = getNode ( state_.zobrist ( ) );
+            if ( Tree::NodeID::invalid == node or state_.ended ( ) ) {
+                return;
+            }
+            m_ponder_thread = std::thread ( [ this, state_, node, max_iterations_, rng = m_rng.split ( ) ] ( ) mutable {
+                Path path ( m_path );
+                index_t path_size = m_path_size;
+                if ( path.back ( ).target != node ) {
+                    path.push ( m_tree.link ( path.back ( ).target, node ) );
+                    ++path_size;
+                }
+                for ( index_t i = 0; i < max_iterations_ and not ( m_ponder_token.cancelled ( ) ); ++i ) {
+                    playout ( node, state_, path, path_size, rng );
+                    if constexpr ( evictable ) {
+                        if ( m_memory_budget and liveMemory ( ) > m_memory_budget ) {
+                            break;
+                        }
                     }
                 }
-                // }
-                m_path.resize ( m_path_size );
+            } );
+        }
+
+        void stopPondering ( ) noexcept {
+            if ( m_ponder_thread.joinable ( ) ) {
+                m_ponder_token.cancel ( );
+                m_ponder_thread.join ( );
+                m_ponder_token.reset ( );
             }
-            return getBestMove ( );
         }
 
         private:
@@ -625,11 +1913,14 @@ namespace mcts {
             new_tree [ new_tree.root_node ] = std::move ( m_tree [ old_node ] );
             // The Visited-vector stores the new NodeID's indexed by old NodeID's,
             // old NodeID's not present in the new tree have a value of NodeID::invalid.
-            static Visited visited;
+            static thread_local Visited visited;
             visited.clear ( );
             visited.resize ( m_tree.nodesSize ( ), Tree::NodeID::invalid );
             visited [ old_node.value ] = new_tree.root_node;
-            static Stack stack;
+            if constexpr ( Layout::struct_of_arrays ) {
+                new_mcts_->m_stats.assign ( new_tree.root_node.value, m_stats, old_node.value );
+            }
+            static thread_local Stack stack;
             stack.clear ( );
             stack.push_back ( old_node );
             while ( stack.size ( ) ) {
@@ -638,27 +1929,21 @@ namespace mcts {
                     const NodeID child { a->target };
                     if ( Tree::NodeID::invalid == visited [ child.value ] ) { // Not visited yet.
                         visited [ child.value ] = new_tree.addNode ( std::move ( m_tree [ child ] ) );
+                        if constexpr ( Layout::struct_of_arrays ) {
+                            new_mcts_->m_stats.assign ( visited [ child.value ].value, m_stats, child.value );
+                        }
                         stack.push_back ( child );
                     }
                     new_tree.addArc ( visited [ parent.value ], visited [ child.value ], std::move ( m_tree [ a.id ( ) ] ) );
                 }
             }
-            // Purge TransitionTable.
-            auto it = m_transposition_table->begin ( );
-            const auto it_cend = m_transposition_table->cend ( );
-            while ( it != it_cend ) {
-                const auto tmp_it = it;
-                ++it;
-                const NodeID new_node = visited [ tmp_it->second.value ];
-                if ( Tree::NodeID::invalid == new_node ) {
-                    m_transposition_table->erase ( tmp_it );
-                }
-                else {
-                    tmp_it->second = new_node;
-                }
-            }
-            // Transfer TranspositionTable.
+            // The TranspositionTable is carried over, to a new generation, its entries
+            // are renumbered by the visited-vector as lookups meet them.
             new_mcts_->m_transposition_table.reset ( m_transposition_table.take ( ) );
+            new_mcts_->m_renumbered_in = new_mcts_->nextTranspositionGeneration ( );
+            if ( new_mcts_->m_renumbered_in ) {
+                new_mcts_->m_renumbered.swap ( visited );
+            }
             // Has been initialized.
             new_mcts_->m_not_initialized = false;
             // Reset path.
@@ -666,24 +1951,104 @@ namespace mcts {
             new_mcts_->m_path_size = 1;
         }
 
+        // The in-place prune: the old root_node is released, and with it, by the
+        // in-degrees (as in release ( ... )), every node that is left without
+        // parents, i.e. the work is in the released nodes only, the surviving
+        // nodes are not visited. The node of state_ becomes the root_node, it
+        // is never released. The released slots are marked and go to the free
+        // lists, to be reused by the next search. The NodeID's of the surviving
+        // nodes don't change, the transposition table moves to a new generation,
+        // in which the entries of the released slots are stale.
+
+        void rebase ( const State & state_ ) noexcept {
+            stopCompaction ( );
+            const NodeID new_root_node = getNode ( state_.zobrist ( ) );
+            if ( new_root_node != m_tree.root_node ) {
+                const std::uint8_t generation = nextTranspositionGeneration ( );
+                m_renumbered.clear ( );
+                // A compaction may have trimmed the tree, the slots beyond it keep
+                // their record, entries into them are still met (and reused slots).
+                if ( m_released_in.size ( ) < m_tree.nodesSize ( ) ) {
+                    m_released_in.resize ( m_tree.nodesSize ( ), 0u );
+                }
+                for ( cOutIt a = m_tree.cbeginOut ( m_tree.root_node ); a.is_valid ( ); ++a ) {
+                    releaseUnreachable ( a->target, new_root_node, generation );
+                }
+                m_tree.clearOut ( m_tree.root_node );
+                m_tree.releaseNode ( m_tree.root_node );
+                m_released_in [ m_tree.root_node.value ] = generation;
+                m_tree.root_node = new_root_node;
+                m_compaction_due = true;
+                m_evict_unmet_at = 0u;
+            }
+            m_path.reset ( m_tree.root_arc, m_tree.root_node );
+            m_path_size = 1;
+        }
+
+        void releaseUnreachable ( const NodeID node_, const NodeID root_node_, const std::uint8_t generation_ ) noexcept {
+            if ( m_tree.releaseIn ( node_ ) and root_node_ != node_ ) {
+                for ( cOutIt a = m_tree.cbeginOut ( node_ ); a.is_valid ( ); ++a ) {
+                    releaseUnreachable ( a->target, root_node_, generation_ );
+                }
+                m_tree.clearOut ( node_ );
+                m_tree.releaseNode ( node_ );
+                m_released_in [ node_.value ] = generation_;
+            }
+        }
+
         public:
 
+        // The moves pool releases pages (madvise) only after the prune of a tree of
+        // at least this many nodes, smaller trees don't free enough whole pages.
+
+        static constexpr std::size_t release_pages_no_nodes = 1'000'000u;
+
+        // A tree that releases nodes (a BlockTree) is rebased in place, otherwise
+        // the surviving subtree is copied into a new instance (InPlace = false
+        // forces the latter).
+
+        template<bool InPlace = evictable>
         static void prune ( Mcts * & mcts_, const State & state_ ) noexcept {
-            Mcts * pruned_mcts = new Mcts ( );
-            if ( not ( mcts_->m_not_initialized ) and Mcts::Tree::NodeID::invalid != mcts_->getNode ( state_.zobrist ( ) ) ) {
-                // The state exists in the tree and it's not the current
-                // root_node, i.e. now prune.
-                mcts_->prune_impl ( pruned_mcts, state_ );
+            static_assert ( not ( InPlace ) or evictable, "an in-place prune requires a tree that releases nodes" );
+            mcts_->stopPondering ( );
+            const std::size_t no_nodes = mcts_->m_tree.nodeNum ( );
+            if constexpr ( InPlace ) {
+                if ( not ( mcts_->m_not_initialized ) and Mcts::Tree::NodeID::invalid != mcts_->getNode ( state_.zobrist ( ) ) ) {
+                    mcts_->rebase ( state_ );
+                }
+                else {
+                    Mcts * pruned_mcts = new Mcts ( );
+                    pruned_mcts->inheritSettings ( * mcts_ );
+                    std::swap ( mcts_, pruned_mcts );
+                    delete pruned_mcts;
+                }
             }
             else {
-                mcts_->initialize ( state_ );
+                Mcts * pruned_mcts = new Mcts ( );
+                pruned_mcts->inheritSettings ( * mcts_ );
+                if ( not ( mcts_->m_not_initialized ) and Mcts::Tree::NodeID::invalid != mcts_->getNode ( state_.zobrist ( ) ) ) {
+                    // The state exists in the tree and it's not the current
+                    // root_node, i.e. now prune.
+                    mcts_->prune_impl ( pruned_mcts, state_ );
+                }
+                else {
+                    mcts_->initialize ( state_ );
+                }
+                std::swap ( mcts_, pruned_mcts );
+                delete pruned_mcts;
+            }
+            // After a large prune (of a large tree, to less than half), the pages of
+            // the freed moves lists are returned to the OS.
+            if constexpr ( requires { NodeData::UntriedMoves::releaseFreePages ( ); } ) {
+                if ( no_nodes >= release_pages_no_nodes and 2 * mcts_->m_tree.nodeNum ( ) < no_nodes ) {
+                    ( void ) NodeData::UntriedMoves::releaseFreePages ( );
+                }
             }
-            std::swap ( mcts_, pruned_mcts );
-            delete pruned_mcts;
         }
 
 
         static void reset ( Mcts * & mcts_, const State & state_ ) noexcept {
+            mcts_->stopPondering ( );
             if ( not ( mcts_->m_not_initialized ) ) {
                 const Mcts::NodeID new_root_node = mcts_->getNode ( state_.zobrist ( ) );
                 if ( Mcts::Tree::NodeID::invalid != new_root_node ) {
@@ -703,10 +2068,10 @@ namespace mcts {
 
 
         [[ nodiscard ]] InverseTranspositionTable invertTranspositionTable ( ) const noexcept {
-            InverseTranspositionTable itt ( m_transposition_table->size ( ) );
-            for ( auto & e : * m_transposition_table ) {
-                itt [ e.second.value ] = e.first;
-            }
+            InverseTranspositionTable itt ( m_tree.nodesSize ( ) );
+            m_transposition_table->forEach ( [ & itt ] ( const ZobristHash zobrist_, const NodeID node_ ) {
+                itt [ node_.value ] = zobrist_;
+            }, transpositionValidator ( ) );
             return itt;
         }
 
@@ -716,52 +2081,67 @@ namespace mcts {
             if ( t_mcts_ == s_mcts_ ) {
                 return;
             }
+            t_mcts_->stopPondering ( );
+            s_mcts_->stopPondering ( );
             // t_mcts_ (target) becomes the largest tree, we're merging the smaller tree (source) into the larger tree.
             if ( t_mcts_->m_tree.nodeNum ( ) < s_mcts_->m_tree.nodeNum ( ) ) {
                 std::swap ( t_mcts_, s_mcts_ );
             }
             // Avoid some levels of indirection and make things clearer.
             Tree & t_t = t_mcts_->m_tree, & s_t = s_mcts_->m_tree; // target tree, source tree.
-            TranspositionTable & t_tt = * t_mcts_->m_transposition_table; // target transposition table.
-            InverseTranspositionTable s_itt { s_mcts_->invertTranspositionTable ( ) }; // source inverse transposition table.
-            // bfs help structures.
-            using Visited = boost::dynamic_bitset<>;
+            // The source inverse transposition table. The keys are rebuilt from the
+            // bucket index, they're only valid in a table of the same number of
+            // buckets, otherwise the trees are merged by the moves alone (and the
+            // nodes added have no transposition entry).
+            const bool same_keys = t_mcts_->m_transposition_table->capacity ( ) == s_mcts_->m_transposition_table->capacity ( );
+            InverseTranspositionTable s_itt = same_keys ? s_mcts_->invertTranspositionTable ( ) : InverseTranspositionTable ( s_t.nodesSize ( ) );
+            // bfs help structures, the target node of every visited source node.
             using Queue = Queue<NodeID>;
-            Visited s_visited { s_t.nodeNum ( ) };
+            std::vector<NodeID> t_nodes ( s_t.nodesSize ( ), Tree::NodeID::invalid );
             Queue s_queue { { s_t.root_node } };
-            s_visited [ s_t.root_node.value ] = true;
+            t_nodes [ s_t.root_node.value ] = t_t.root_node;
+            mergeNode ( t_mcts_, t_t.root_node, s_mcts_, s_t.root_node );
             // Walk the tree, breadth first.
             while ( s_queue.not_empty ( ) ) {
                 // The t_source (target parent) does always exist, as we are going at it breadth first.
-                const NodeID s_source = s_queue.pop ( ), t_source = t_tt.find ( s_itt [ s_source.value ] )->second;
+                const NodeID s_source = s_queue.pop ( ), t_source = t_nodes [ s_source.value ];
                 // Iterate over children (targets) of the parent (source).
                 for ( OutIt soi { s_t, s_source }; soi.is_valid ( ); ++soi ) { // Source Out Iterator (soi).
                     const Link s_link = s_t.link ( soi );
-                    if ( not ( s_visited [ s_link.target.value ] ) ) {
-                        s_visited [ s_link.target.value ] = true;
-                        s_queue.push ( s_link.target );
-                        // Now do something. If child in s_mcts_ doesn't exist in t_mcts_, add child.
-                        const auto t_it = t_tt.find ( s_itt [ s_link.target.value ] );
-                        if ( t_it != t_tt.cend ( ) ) { // Child exists. The arc does or does not exist.
-                            // NodeID t_it->second corresponds to NodeID target child.
-                            const Link t_link ( t_t.link ( t_source, t_it->second ) );
-                            if ( Tree::ArcID::invalid != t_link.arc ) { // The arc does exist.
-                                t_t [ t_link.arc.value ] += s_t [ s_link.arc.value ];
+                    // The arc of the move is looked up first, the transposition table is
+                    // bounded and may have lost (or replaced) the entry of its target.
+                    Link t_link = t_mcts_->childByMove ( t_source, s_t [ s_link.arc ].m_move );
+                    const bool visited = Tree::NodeID::invalid != t_nodes [ s_link.target.value ];
+                    bool added = false;
+                    if ( Tree::ArcID::invalid != t_link.arc ) { // The arc does exist.
+                        t_t [ t_link.arc ] += s_t [ s_link.arc ];
+                    }
+                    else { // The arc does not exist. The child does or does not exist.
+                        const ZobristHash zobrist = s_itt [ s_link.target.value ];
+                        const NodeID t_child = visited ? t_nodes [ s_link.target.value ] : ZobristHash { 0 } != zobrist ? t_mcts_->getNode ( zobrist ) : Tree::NodeID::invalid;
+                        if ( Tree::NodeID::invalid != t_child ) { // Child exists.
+                            t_link = t_t.addArc ( t_source, t_child );
+                        }
+                        else { // Child does not exist.
+                            t_link = t_t.addNode ( t_source );
+                            t_t [ t_link.target ] = std::move ( s_t [ s_link.target ] );
+                            if constexpr ( Layout::struct_of_arrays ) {
+                                t_mcts_->m_stats.assign ( t_link.target.value, s_mcts_->m_stats, s_link.target.value );
                             }
-                            else { // The arc does not exist.
-                                t_t [ t_t.addArc ( t_source, t_link.target ).arc.value ] = std::move ( s_t [ s_link.arc.value ] );
+                            if ( ZobristHash { 0 } != zobrist ) {
+                                t_mcts_->insertTransposition ( zobrist, t_link.target );
                             }
-                            // Update the values of the target.
-                            t_t [ t_link.target.value ] += s_t [ s_link.target.value ];
+                            added = true;
                         }
-                        else { // Child does not exist.
-                            const Link t_link = t_t.addNode ( t_source );
-                            // m_tree.
-                            t_t [ t_link.arc.value    ] = std::move ( s_t [ s_link.arc.value    ] );
-                            t_t [ t_link.target.value ] = std::move ( s_t [ s_link.target.value ] );
-                            // m_transposition_table.
-                            t_tt.emplace ( s_itt [ s_link.target.value ], t_link.target );
+                        t_t [ t_link.arc ] = std::move ( s_t [ s_link.arc ] );
+                    }
+                    if ( not ( visited ) ) {
+                        // Now do something, update the values of the target (if it was there).
+                        if ( not ( added ) ) {
+                            mergeNode ( t_mcts_, t_link.target, s_mcts_, s_link.target );
                         }
+                        t_nodes [ s_link.target.value ] = t_link.target;
+                        s_queue.push ( s_link.target );
                     }
                 }
             }
@@ -772,11 +2152,22 @@ namespace mcts {
         }
 
 
+        // Adds the statistics of s_node_ to t_node_ (of the same position), the
+        // moves tried in either are tried.
+        static void mergeNode ( Mcts * t_mcts_, const NodeID t_node_, Mcts * s_mcts_, const NodeID s_node_ ) noexcept {
+            t_mcts_->m_tree [ t_node_ ] += s_mcts_->m_tree [ s_node_ ];
+            t_mcts_->m_tree [ t_node_ ].retainUntriedMoves ( s_mcts_->m_tree [ s_node_ ] );
+            if constexpr ( Layout::struct_of_arrays ) {
+                t_mcts_->m_stats.add ( t_node_.value, s_mcts_->m_stats, s_node_.value );
+            }
+        }
+
+
         std::size_t numTranspositions ( ) const noexcept {
             std::size_t nt = 0;
             using Visited = boost::dynamic_bitset<>;
             using Stack = Stack<NodeID>;
-            Visited visited { m_tree.nodeNum ( ) };
+            Visited visited { m_tree.nodesSize ( ) };
             Stack stack { m_tree.root_node };
             visited [ m_tree.root_node.value ] = true;
             while ( stack.not_empty ( ) ) {
@@ -802,18 +2193,24 @@ namespace mcts {
         template < class Archive >
         void save ( Archive & ar_ ) const noexcept {
             ar_ ( m_tree, * m_transposition_table, m_not_initialized );
+            if constexpr ( Layout::struct_of_arrays ) {
+                ar_ ( m_stats );
+            }
         }
 
         template < class Archive >
         void load ( Archive & ar_ ) noexcept {
             m_tree.clearUnsafe ( );
             if ( m_transposition_table.get ( ) == nullptr ) {
-                m_transposition_table.reset ( new TranspositionTable ( ) );
+                m_transposition_table.reset ( new TranspositionTable ( Tree::NodeID::invalid, transpositionTableBytes ( ) ) );
             }
             else {
                 m_transposition_table->clear ( );
             }
             ar_ ( m_tree, * m_transposition_table, m_not_initialized );
+            if constexpr ( Layout::struct_of_arrays ) {
+                ar_ ( m_stats );
+            }
             m_path.reset ( m_tree.root_arc, m_tree.root_node );
             m_path_size = 1;
         }
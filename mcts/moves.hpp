@@ -85,8 +85,8 @@ public:
         assert ( m_size <= S );
     }
 
-    [[ nodiscard ]] value_type random ( ) const noexcept {
-        return m_moves [ std::uniform_int_distribution < ptrdiff_t > ( 0, m_size - 1 ) ( g_rng ) ];
+    [[ nodiscard ]] value_type random ( rng_t & rng_ ) const noexcept {
+        return m_moves [ std::uniform_int_distribution < ptrdiff_t > ( 0, m_size - 1 ) ( rng_ ) ];
     }
 
     [[ nodiscard ]] bool find ( const value_type m_ ) const noexcept {
@@ -98,12 +98,12 @@ public:
         return false;
     }
 
-    [[ nodiscard ]] value_type draw ( ) noexcept {
+    [[ nodiscard ]] value_type draw ( rng_t & rng_ ) noexcept {
         if ( 1 == m_size ) {
             return m_moves [ --m_size ];
         }
         else {
-            const index_t i = std::uniform_int_distribution < index_t > ( 0, m_size - 1 ) ( g_rng );
+            const index_t i = std::uniform_int_distribution < index_t > ( 0, m_size - 1 ) ( rng_ );
             const value_type v = m_moves [ i ];
             m_moves [ i ] = m_moves [ --m_size ];
             assert ( m_size >= 0 );
@@ -0,0 +1,186 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+
+#include "Typedefs.hpp"
+#include "player.hpp"
+
+
+namespace mcts {
+
+    // An allocator of cache line (64 bytes) aligned storage.
+
+    template<typename T, std::size_t Alignment = 64>
+    struct AlignedAllocator {
+
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator ( ) noexcept = default;
+        template<typename U>
+        AlignedAllocator ( const AlignedAllocator<U, Alignment> & ) noexcept { }
+
+        [[ nodiscard ]] T * allocate ( const std::size_t n_ ) {
+            return static_cast<T *> ( ::operator new ( n_ * sizeof ( T ), std::align_val_t { Alignment } ) );
+        }
+
+        void deallocate ( T * p_, const std::size_t ) noexcept {
+            ::operator delete ( p_, std::align_val_t { Alignment } );
+        }
+
+        template<typename U>
+        [[ nodiscard ]] bool operator == ( const AlignedAllocator<U, Alignment> & ) const noexcept { return true; }
+        template<typename U>
+        [[ nodiscard ]] bool operator != ( const AlignedAllocator<U, Alignment> & ) const noexcept { return false; }
+    };
+
+    template<typename T>
+    using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+
+    // The statistics of the nodes of a tree, as a struct of arrays, indexed by
+    // the value of the NodeID. Selection only reads the visits and the scores,
+    // 8 bytes per child, streamed from two arrays, instead of pulling in the
+    // whole node record (and the moves pointer).
+
+    class NodeStats {
+
+        aligned_vector<std::int32_t> m_visits;
+        aligned_vector<float> m_scores;
+        aligned_vector<Player> m_players_just_moved;
+
+    public:
+
+        [[ nodiscard ]] std::size_t size ( ) const noexcept {
+            return m_visits.size ( );
+        }
+
+        // Grows the arrays (geometrically) to hold index_.
+
+        void reserve ( const std::size_t index_ ) {
+            if ( index_ >= m_visits.size ( ) ) {
+                const std::size_t size = std::max ( 2 * m_visits.size ( ), std::max ( index_ + 1, std::size_t { 1024 } ) );
+                m_visits.resize ( size, 0 );
+                m_scores.resize ( size, 0.0f );
+                m_players_just_moved.resize ( size, Player::Type::invalid );
+            }
+        }
+
+        void emplace ( const std::size_t index_, const Player player_just_moved_ ) {
+            reserve ( index_ );
+            m_visits [ index_ ] = 0;
+            m_scores [ index_ ] = 0.0f;
+            m_players_just_moved [ index_ ] = player_just_moved_;
+        }
+
+        // Copies the statistics of node s_index_ of stats_ to node index_.
+
+        void assign ( const std::size_t index_, const NodeStats & stats_, const std::size_t s_index_ ) {
+            reserve ( index_ );
+            m_visits [ index_ ] = stats_.m_visits [ s_index_ ];
+            m_scores [ index_ ] = stats_.m_scores [ s_index_ ];
+            m_players_just_moved [ index_ ] = stats_.m_players_just_moved [ s_index_ ];
+        }
+
+        void add ( const std::size_t index_, const NodeStats & stats_, const std::size_t s_index_ ) noexcept {
+            m_visits [ index_ ] += stats_.m_visits [ s_index_ ];
+            m_scores [ index_ ] += stats_.m_scores [ s_index_ ];
+        }
+
+        void clear ( ) noexcept {
+            m_visits.clear ( );
+            m_scores.clear ( );
+            m_players_just_moved.clear ( );
+        }
+
+        // Relaxed atomic access, as for NodeData.
+
+        [[ nodiscard ]] std::int32_t visits ( const std::size_t index_ ) const noexcept {
+            return std::atomic_ref<std::int32_t> ( const_cast<std::int32_t &> ( m_visits [ index_ ] ) ).load ( std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] float score ( const std::size_t index_ ) const noexcept {
+            return std::atomic_ref<float> ( const_cast<float &> ( m_scores [ index_ ] ) ).load ( std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] Player playerJustMoved ( const std::size_t index_ ) const noexcept {
+            return m_players_just_moved [ index_ ];
+        }
+
+        void add ( const std::size_t index_, const float score_, const std::int32_t visits_ ) noexcept {
+            m_visits [ index_ ] += visits_;
+            m_scores [ index_ ] += score_;
+        }
+
+        void atomicAdd ( const std::size_t index_, const float score_, const std::int32_t visits_ ) noexcept {
+            std::atomic_ref<float> ( m_scores [ index_ ] ).fetch_add ( score_, std::memory_order_relaxed );
+            std::atomic_ref<std::int32_t> ( m_visits [ index_ ] ).fetch_add ( visits_, std::memory_order_relaxed );
+        }
+
+        [[ nodiscard ]] std::size_t memory ( ) const noexcept {
+            return m_visits.capacity ( ) * ( sizeof ( std::int32_t ) + sizeof ( float ) + sizeof ( Player ) );
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void save ( Archive & ar_ ) const {
+            const std::uint64_t size = m_visits.size ( );
+            ar_ ( size );
+            ar_ ( cereal::binary_data ( m_visits.data ( ), size * sizeof ( std::int32_t ) ) );
+            ar_ ( cereal::binary_data ( m_scores.data ( ), size * sizeof ( float ) ) );
+            ar_ ( cereal::binary_data ( m_players_just_moved.data ( ), size * sizeof ( Player ) ) );
+        }
+
+        template < class Archive >
+        void load ( Archive & ar_ ) {
+            std::uint64_t size = 0;
+            ar_ ( size );
+            m_visits.resize ( size );
+            m_scores.resize ( size );
+            m_players_just_moved.resize ( size );
+            ar_ ( cereal::binary_data ( m_visits.data ( ), size * sizeof ( std::int32_t ) ) );
+            ar_ ( cereal::binary_data ( m_scores.data ( ), size * sizeof ( float ) ) );
+            ar_ ( cereal::binary_data ( m_players_just_moved.data ( ), size * sizeof ( Player ) ) );
+        }
+    };
+}
@@ -32,6 +32,7 @@
 #include <numeric>
 #include <utility>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <functional>
 
@@ -362,7 +363,7 @@ private:
 
     Move m_last_move = Move::root;
 
-    bool is_once_initialized = false;
+    static std::once_flag m_once_flag;
 
     static ZobristHashKeys m_zobrist_keys;
     static const ZobristHash m_zobrist_player_key_values [ 3 ];
@@ -376,20 +377,21 @@ public:
         std::memcpy ( this, & s_, sizeof ( OskaStateTemplate ) );
     }
 
-    void once_initialize ( ) {
+    // The static tables (geometry, lookup tables and zobrist keys) are shared by
+    // all instances and are set up exactly once, also with states being
+    // initialized concurrently from multiple threads.
+
+    static void once_initialize ( ) {
         ResourceData resource_data ( S );
         Hexagon::initialize ( resource_data.m_xara_hex_dim );
-        // Set all fields of boards to Player::Type::invalid.
         index_t r, c;
         for ( r = 0; r < OB_ROWS ( S ); ++r ) {
             for ( c = 0; c < OB_COLS ( S ); ++c ) {
                 m_location_to_id.at ( c, r ) = -1;
-                m_human_board.at ( c, r ) = m_agent_board.at ( c, r ) = Player::Type::invalid;
             }
         }
         std::uniform_int_distribution<std::size_t> dist;
         // Top of the board.
-        m_agent_stone_id.reserve ( S );
         index_t li = 1, ri = OB_COLS ( S ) - 1, id = 0;
         float y = 0.5f * resource_data.m_xara_hex_dim.y + resource_data.m_margin;
         for ( r = 1; r < OB_ROWS ( S ) / 2; ++r, ++li, --ri ) {
@@ -398,34 +400,21 @@ public:
                 m_point_to_id.insert ( std::make_pair ( toArray ( m_hexagons.at ( id ).center ( ) ), id ) );
                 m_location_to_id.at ( c, r ) = id;
                 m_id_to_location.at ( id ) = std::move ( Location ( c, r ) );
-                m_human_board.at_r ( c, r ) = m_agent_board.at ( c, r ) = r == 1 ? Player::Type::agent : Player::Type::vacant;
                 m_zobrist_keys.at ( 0, c, r ) = dist ( g_rng );
                 m_zobrist_keys.at ( 1, c, r ) = dist ( g_rng );
-                if ( r == 1 ) {
-                    const Player player = Player::Type::agent;
-                    m_zobrist_hash ^= m_zobrist_keys.at ( player.as_01index ( ), c, r );
-                    m_agent_stone_id.emplace_back ( id );
-                }
                 ++id;
             }
             y += 0.75f * resource_data.m_xara_hex_dim.y;
         }
         // Bottom of the board, r, li and ri "fall through" from top of board.
-        m_human_stone_id.reserve ( S );
         for ( ; r < OB_ROWS ( S ) - 1; ++r, --li, ++ri ) {
             for ( c = li; c < ri; c += 2 ) {
                 m_hexagons.at ( id ) = std::move ( Hexagon ( Point ( c * 0.5f * resource_data.m_xara_hex_dim.x + resource_data.m_margin, y ) ) );
                 m_point_to_id.insert ( std::make_pair ( toArray ( m_hexagons.at ( id ).center ( ) ), id ) );
                 m_location_to_id.at ( c, r ) = id;
                 m_id_to_location.at ( id ) = std::move ( Location ( c, r ) );
-                m_human_board.at_r ( c, r ) = m_agent_board.at ( c, r ) = r == OB_HOME_ROW ( S ) ? Player::Type::human : Player::Type::vacant;
                 m_zobrist_keys.at ( 0, c, r ) = dist ( g_rng );
                 m_zobrist_keys.at ( 1, c, r ) = dist ( g_rng );
-                if ( r == OB_HOME_ROW ( S ) ) {
-                    const Player player = Player::Type::human;
-                    m_zobrist_hash ^= m_zobrist_keys.at ( player.as_01index ( ), c, r );
-                    m_human_stone_id.emplace_back ( id );
-                }
                 ++id;
             }
             y += 0.75f * resource_data.m_xara_hex_dim.y;
@@ -434,23 +423,25 @@ public:
     }
 
     void initialize ( ) {
-        if ( not ( is_once_initialized ) ) {
-            is_once_initialized = true;
-            return once_initialize ( );
-        }
+        std::call_once ( m_once_flag, once_initialize );
+        // Set all fields of boards to Player::Type::invalid.
         index_t r, c;
         for ( r = 0; r < OB_ROWS ( S ); ++r ) {
             for ( c = 0; c < OB_COLS ( S ); ++c ) {
                 m_human_board.at ( c, r ) = m_agent_board.at ( c, r ) = Player::Type::invalid;
             }
         }
+        m_zobrist_hash = m_zobrist_player_keys [ ( index_t ) Player::Type::vacant ];
         // Top of the board.
         m_agent_stone_id.clear ( );
+        m_agent_stone_id.reserve ( S );
         index_t li = 1, ri = OB_COLS ( S ) - 1, id = 0;
         for ( r = 1; r < OB_ROWS ( S ) / 2; ++r, ++li, --ri ) {
             for ( c = li; c < ri; c += 2 ) {
                 m_human_board.at_r ( c, r ) = m_agent_board.at ( c, r ) = r == 1 ? Player::Type::agent : Player::Type::vacant;
                 if ( r == 1 ) {
+                    const Player player = Player::Type::agent;
+                    m_zobrist_hash ^= m_zobrist_keys.at ( player.as_01index ( ), c, r );
                     m_agent_stone_id.emplace_back ( id );
                 }
                 ++id;
@@ -458,10 +449,13 @@ public:
         }
         // Bottom of the board, r, li and ri "fall through" from top of board.
         m_human_stone_id.clear ( );
+        m_human_stone_id.reserve ( S );
         for ( ; r < OB_ROWS ( S ) - 1; ++r, --li, ++ri ) {
             for ( c = li; c < ri; c += 2 ) {
                 m_human_board.at_r ( c, r ) = m_agent_board.at ( c, r ) = r == OB_HOME_ROW ( S ) ? Player::Type::human : Player::Type::vacant;
                 if ( r == OB_HOME_ROW ( S ) ) {
+                    const Player player = Player::Type::human;
+                    m_zobrist_hash ^= m_zobrist_keys.at ( player.as_01index ( ), c, r );
                     m_human_stone_id.emplace_back ( id );
                 }
                 ++id;
@@ -572,14 +566,14 @@ public:
         return Location ( ( OB_COLS ( S ) - 1 ), ( OB_ROWS ( S ) - 1 ) ) - l_;
     }
 
-    [[ nodiscard ]] Move const randomMove ( ) const noexcept {
+    [[ nodiscard ]] Move const randomMove ( rng_t & rng_ ) const noexcept {
         Move move;
         if ( m_player_to_move == Player::Type::agent ) {
             StoneID ids ( m_agent_stone_id );
             while ( ids.size ( ) ) {
-                const index_t i = std::uniform_int_distribution<index_t> ( 0, ( index_t ) ids.size ( ) - 1 ) ( g_rng );
+                const index_t i = std::uniform_int_distribution<index_t> ( 0, ( index_t ) ids.size ( ) - 1 ) ( rng_ );
                 const Location loc = m_id_to_location.at ( ids [ i ] );
-                if ( bernoulli ( ) ) {
+                if ( bernoulli ( rng_ ) ) {
                     move = leftMove ( m_agent_board, loc.c, loc.r );
                     if ( move not_eq Move::invalid ) {
                         return move;
@@ -605,9 +599,9 @@ public:
         else {
             StoneID ids ( m_human_stone_id );
             while ( ids.size ( ) ) {
-                const index_t i = std::uniform_int_distribution<index_t> ( 0, ( index_t ) ids.size ( ) - 1 ) ( g_rng );
+                const index_t i = std::uniform_int_distribution<index_t> ( 0, ( index_t ) ids.size ( ) - 1 ) ( rng_ );
                 const Location loc = m_id_to_location.at_r ( ids [ i ] );
-                if ( bernoulli ( ) ) {
+                if ( bernoulli ( rng_ ) ) {
                     move = leftMove ( m_human_board, loc.c, loc.r );
                     if ( move not_eq Move::invalid ) {
                         return move;
@@ -634,7 +628,7 @@ public:
     }
 
     [[ nodiscard ]] Move const agentMove ( ) const noexcept {
-        return randomMove ( );
+        return randomMove ( g_rng );
     }
 
     [[ nodiscard ]] Move const humanMove ( const index_t f_, const index_t t_ ) const noexcept {
@@ -836,10 +830,10 @@ public:
     }
 
 
-    void simulate ( ) noexcept {
+    void simulate ( rng_t & rng_ ) noexcept {
         Moves m;
         while ( moves ( & m ) ) {
-            move_winner ( m.random ( ) );
+            move_winner ( m.random ( rng_ ) );
         }
     }
 
@@ -970,6 +964,8 @@ typename OskaStateTemplate<S>::LocationToID OskaStateTemplate<S>::m_location_to_
 template <index_t S>
 typename OskaStateTemplate<S>::IDToLocation OskaStateTemplate<S>::m_id_to_location;
 template <index_t S>
+std::once_flag OskaStateTemplate<S>::m_once_flag;
+template <index_t S>
 typename OskaStateTemplate<S>::ZobristHashKeys OskaStateTemplate<S>::m_zobrist_keys;
 template <index_t S>
 const typename OskaStateTemplate<S>::ZobristHash OskaStateTemplate<S>::m_zobrist_player_key_values [ 3 ] {
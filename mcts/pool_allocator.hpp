@@ -28,7 +28,12 @@
 
 #pragma once
 
+#if defined ( _WIN32 )
 #include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include <cassert>
 #include <climits>
@@ -39,9 +44,11 @@
 
 #include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 
+#if defined ( _WIN32 )
 extern "C" {
 
     WINBASEAPI
@@ -54,9 +61,18 @@ extern "C" {
     WINAPI
     VirtualFree ( LPVOID, SIZE_T, DWORD );
 }
+#endif
 
 namespace pa {
 
+    // A PageSize of huge_page_size (or a multiple) maps the blocks on huge
+    // pages, on Linux reserved (MAP_HUGETLB) ones if available, transparent
+    // ones otherwise, on Windows large pages if the process holds the lock
+    // pages privilege, normal pages otherwise.
+
+    inline constexpr std::size_t page_size = 4'096;
+    inline constexpr std::size_t huge_page_size = 2 * 1'024 * 1'024;
+
     namespace detail {
 
         template<typename T, std::size_t ChunkCount, std::size_t PageSize = 4096, std::size_t MinAlloc = 8>
@@ -101,6 +117,14 @@ namespace pa {
             static constexpr size_type max_size ( ) noexcept;
 
             size_type memory_size ( ) const noexcept;
+            size_type released_size ( ) const noexcept;
+
+            // Returns the pages that hold free slots only to the OS (f.e. after a
+            // large prune), these slots are handed out again (and the pages are
+            // faulted in again) once the free list is exhausted. Returns the
+            // number of bytes released.
+
+            size_type release_free_pages ( ) noexcept;
 
             private:
 
@@ -119,11 +143,20 @@ namespace pa {
                 ~Slot ( ) = delete;
             };
 
-            SlotPointer m_current_block;
+            SlotPtrVector m_blocks; // The mapped blocks, the last one is the current block.
             SlotPointer m_current_slot;
             SlotPointer m_last_slot;
             SlotPointer m_free_slots;
 
+            struct ReleasedSlots { // A range of slots on size bytes of released pages.
+
+                SlotPointer first, last;
+                size_type size;
+            };
+
+            std::vector<ReleasedSlots> m_released_slots;
+            size_type m_released_size;
+
             size_type pad_pointer ( const DataPtr p_, const size_type align_ ) const noexcept;
             void allocate_block ( );
             SlotPointer first_slot ( const SlotPointer block_ ) const noexcept;
@@ -133,6 +166,7 @@ namespace pa {
 
             inline SlotPointer virtual_alloc ( const size_type size_ ) const noexcept;
             inline void virtual_free ( const SlotPointer block_ ) const noexcept;
+            inline bool virtual_release ( const DataPtr begin_, const DataPtr end_ ) const noexcept;
         };
 
 
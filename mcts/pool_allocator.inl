@@ -47,10 +47,12 @@ namespace pa {
         template<typename T, std::size_t ChunkCount, std::size_t PageSize, std::size_t MinAlloc>
         chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::chunk_pool_allocator ( )
             noexcept
-            : m_current_block ( nullptr )
+            : m_blocks ( )
             , m_current_slot ( nullptr )
             , m_last_slot ( nullptr )
             , m_free_slots ( nullptr )
+            , m_released_slots ( )
+            , m_released_size ( 0 )
         {
         }
 
@@ -68,10 +70,12 @@ namespace pa {
         template<typename T, std::size_t ChunkCount, std::size_t PageSize, std::size_t MinAlloc>
         chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::chunk_pool_allocator ( chunk_pool_allocator && chunk_pool_ )
             noexcept
-            : m_current_block ( chunk_pool_.m_current_block )
+            : m_blocks ( std::move ( chunk_pool_.m_blocks ) )
             , m_current_slot ( chunk_pool_.m_current_slot )
             , m_last_slot ( chunk_pool_.m_last_slot )
             , m_free_slots ( chunk_pool_.m_free_slots )
+            , m_released_slots ( std::move ( chunk_pool_.m_released_slots ) )
+            , m_released_size ( chunk_pool_.m_released_size )
         {
         }
 
@@ -94,10 +98,12 @@ namespace pa {
         {
             if ( this != &chunk_pool_ ) {
 
-                std::swap ( m_current_block, chunk_pool_.m_current_block );
+                std::swap ( m_blocks, chunk_pool_.m_blocks );
                 m_current_slot = chunk_pool_.m_current_slot;
                 m_last_slot = chunk_pool_.m_last_slot;
-                m_free_slots = chunk_pool_.freeSlots;
+                m_free_slots = chunk_pool_.m_free_slots;
+                std::swap ( m_released_slots, chunk_pool_.m_released_slots );
+                m_released_size = chunk_pool_.m_released_size;
             }
 
             return * this;
@@ -119,24 +125,21 @@ namespace pa {
 
                     SlotPtrVector sorted_free_vector = pointer_vector ( m_free_slots );
 
-                    SlotPointer curr = m_current_block, last = m_current_slot, prev = nullptr, ptr = nullptr;
+                    SlotPointer ptr = nullptr;
 
                     if ( sorted_free_vector.empty ( ) ) {
 
-                        while ( curr != nullptr ) {
+                        for ( typename SlotPtrVector::const_reverse_iterator curr = std::crbegin ( m_blocks ); curr != std::crend ( m_blocks ); ++curr ) {
 
-                            prev = curr->next;
-                            ptr = first_slot ( curr );
+                            const SlotPointer last = std::crbegin ( m_blocks ) == curr ? m_current_slot : last_slot ( *curr );
+                            ptr = first_slot ( *curr );
 
                             while ( ptr < last ) {
 
                                 reinterpret_cast<pointer>( ptr++ )->~value_type ( );
                             }
 
-                            virtual_free ( curr );
-
-                            curr = prev;
-                            last = last_slot ( curr );
+                            virtual_free ( *curr );
                         }
                     }
 
@@ -144,10 +147,10 @@ namespace pa {
 
                         ska_sort ( std::begin ( sorted_free_vector ), std::end ( sorted_free_vector ) );
 
-                        while ( curr != nullptr ) {
+                        for ( typename SlotPtrVector::const_reverse_iterator curr = std::crbegin ( m_blocks ); curr != std::crend ( m_blocks ); ++curr ) {
 
-                            prev = curr->next;
-                            ptr = first_slot ( curr );
+                            const SlotPointer last = std::crbegin ( m_blocks ) == curr ? m_current_slot : last_slot ( *curr );
+                            ptr = first_slot ( *curr );
 
                             while ( ptr < last ) {
 
@@ -159,10 +162,7 @@ namespace pa {
                                 ++ptr;
                             }
 
-                            virtual_free ( curr );
-
-                            curr = prev;
-                            last = last_slot ( curr );
+                            virtual_free ( *curr );
                         }
                     }
                 }
@@ -175,20 +175,18 @@ namespace pa {
 
             else if constexpr ( std::is_trivially_destructible<T>::value ) {
 
-                SlotPointer curr = m_current_block;
-
-                while ( curr != nullptr ) {
+                for ( const SlotPointer block : m_blocks ) {
 
-                    SlotPointer prev = curr->next;
-                    virtual_free ( curr );
-                    curr = prev;
+                    virtual_free ( block );
                 }
             }
 
-            m_current_block = nullptr;
+            m_blocks.clear ( );
             m_current_slot = nullptr;
             m_last_slot = nullptr;
             m_free_slots = nullptr;
+            m_released_slots.clear ( );
+            m_released_size = 0;
         }
 
 
@@ -197,17 +195,14 @@ namespace pa {
         void
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::allocate_block ( )
         {
-            // Allocate space for the new block and store a pointer to the previous one...
+            // Allocate space for the new block, the blocks are kept out of band, so
+            // that a block holds slots only (and its pages can be released)...
 
-            SlotPointer new_block = virtual_alloc ( block_size ( ) );
-            new_block->next = m_current_block;
-            m_current_block = new_block;
+            const SlotPointer new_block = virtual_alloc ( block_size ( ) );
+            m_blocks.push_back ( new_block );
 
-            // Pad block body to satisfy the alignment requirements for elements...
-
-            DataPtr body = reinterpret_cast<DataPtr> ( new_block ) + sizeof ( SlotPointer );
-            m_current_slot = reinterpret_cast<SlotPointer> ( body + pad_pointer ( body, alignof ( SlotType ) ) );
-            m_last_slot = reinterpret_cast<SlotPointer> ( reinterpret_cast<DataPtr> ( m_current_slot ) + chunk_size ( ) );
+            m_current_slot = first_slot ( new_block );
+            m_last_slot = last_slot ( new_block );
         }
 
 
@@ -227,7 +222,20 @@ namespace pa {
 
                 if ( m_current_slot >= m_last_slot ) {
 
-                    allocate_block ( );
+                    if ( m_released_slots.size ( ) ) {
+
+                        // Hand out the slots on released pages first, before mapping a new block...
+
+                        m_current_slot = m_released_slots.back ( ).first;
+                        m_last_slot = m_released_slots.back ( ).last;
+                        m_released_size -= m_released_slots.back ( ).size;
+                        m_released_slots.pop_back ( );
+                    }
+
+                    else {
+
+                        allocate_block ( );
+                    }
                 }
 
                 const pointer result = reinterpret_cast<pointer> ( m_current_slot );
@@ -266,7 +274,9 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::no_chunks ( )
             noexcept
         {
-            return ( block_size ( ) - sizeof ( SlotPointer ) - alignof ( value_type ) ) / chunk_size ( );
+            // Blocks are page aligned, the slots need no padding...
+
+            return block_size ( ) / chunk_size ( );
         }
 
         // chunk_size in bytes...
@@ -276,7 +286,7 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::chunk_size ( )
             noexcept
         {
-            return ChunkCount * sizeof ( value_type );
+            return ChunkCount * sizeof ( SlotType );
         }
 
 
@@ -286,7 +296,7 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::block_size ( )
             noexcept
         {
-            const size_type minimum_required_block_size = sizeof ( SlotPointer ) + MinAlloc * chunk_size ( ) + alignof ( value_type );
+            const size_type minimum_required_block_size = MinAlloc * chunk_size ( );
             size_type bs = PageSize;
 
             while ( bs < minimum_required_block_size ) {
@@ -315,16 +325,85 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::memory_size ( )
             const noexcept
         {
-            SlotPointer sp = m_current_block;
-            size_type ms = 0;
+            return m_blocks.size ( ) * block_size ( );
+        }
+
+
+
+        template<typename T, std::size_t ChunkCount, std::size_t PageSize, std::size_t MinAlloc>
+        typename chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::size_type
+            chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::released_size ( )
+            const noexcept
+        {
+            return m_released_size;
+        }
+
+
+
+        template<typename T, std::size_t ChunkCount, std::size_t PageSize, std::size_t MinAlloc>
+        typename chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::size_type
+            chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::release_free_pages ( )
+            noexcept
+        {
+            // The destructor (of a non-trivially destructible T) would otherwise
+            // have to find the slots on released pages as well...
+
+            static_assert ( std::is_trivially_destructible<T>::value, "release_free_pages ( ) requires a trivially destructible T." );
+
+            if ( nullptr == m_free_slots ) {
+
+                return 0;
+            }
+
+            SlotPtrVector sorted_free_vector = pointer_vector ( m_free_slots ), sorted_block_vector = m_blocks;
+            std::sort ( std::begin ( sorted_free_vector ), std::end ( sorted_free_vector ) );
+            std::sort ( std::begin ( sorted_block_vector ), std::end ( sorted_block_vector ) );
+
+            // Runs of adjacent free chunks (a run crosses a block boundary only if the
+            // blocks are adjacent in memory) that cover whole pages are released (the
+            // unused tail of a block counts as free), the remaining chunks are threaded
+            // back onto the free list, in address order. Pages are released at the base
+            // page granularity, this splits transparent huge pages...
+
+            const size_type released_size = m_released_size;
+            SlotPointer * free_slots = & m_free_slots;
+            typename SlotPtrVector::const_iterator first = std::cbegin ( sorted_free_vector );
+
+            while ( first != std::cend ( sorted_free_vector ) ) {
+
+                typename SlotPtrVector::const_iterator last = std::next ( first );
+
+                while ( last != std::cend ( sorted_free_vector ) and *last == *std::prev ( last ) + ChunkCount ) {
+
+                    ++last;
+                }
+
+                const SlotPointer end_slot = *std::prev ( last ) + ChunkCount;
+                const SlotPointer block = *std::prev ( std::upper_bound ( std::cbegin ( sorted_block_vector ), std::cend ( sorted_block_vector ), *std::prev ( last ) ) );
+                const DataPtr begin = reinterpret_cast<DataPtr> ( *first ), end = last_slot ( block ) == end_slot ? reinterpret_cast<DataPtr> ( block ) + block_size ( ) : reinterpret_cast<DataPtr> ( end_slot );
+                const DataPtr page_begin = begin + pad_pointer ( begin, page_size ), page_end = end - reinterpret_cast<std::uintptr_t> ( end ) % page_size;
+
+                if ( page_begin < page_end and virtual_release ( page_begin, page_end ) ) {
 
-            while ( sp != nullptr ) {
+                    m_released_slots.push_back ( { *first, end_slot, static_cast<size_type> ( page_end - page_begin ) } );
+                    m_released_size += page_end - page_begin;
+                }
+
+                else {
 
-                ms += block_size ( );
-                sp = sp->next;
+                    for ( ; first != last; ++first ) {
+
+                        *free_slots = *first;
+                        free_slots = & ( *first )->next;
+                    }
+                }
+
+                first = last;
             }
 
-            return ms;
+            *free_slots = nullptr;
+
+            return m_released_size - released_size;
         }
 
 
@@ -334,8 +413,7 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::first_slot ( const SlotPointer block_ )
             const noexcept
         {
-            const DataPtr body = reinterpret_cast<DataPtr>( block_ ) + sizeof ( SlotPointer );
-            return reinterpret_cast<SlotPointer> ( body + pad_pointer ( body, alignof ( SlotType ) ) );
+            return block_;
         }
 
 
@@ -345,8 +423,7 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::last_slot ( const SlotPointer block_ )
             const noexcept
         {
-            const DataPtr body = reinterpret_cast<DataPtr>( block_ ) + sizeof ( SlotPointer );
-            return reinterpret_cast<SlotPointer> ( body + pad_pointer ( body, alignof ( SlotType ) ) + chunk_size ( ) );
+            return block_ + no_chunks ( ) * ChunkCount;
         }
 
 
@@ -375,7 +452,7 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::block_vector ( )
             const noexcept
         {
-            return pointer_vector ( m_current_block );
+            return m_blocks;
         }
 
 
@@ -385,7 +462,62 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::virtual_alloc ( const size_type size_ )
             const noexcept
         {
+#if defined ( _WIN32 )
+            if constexpr ( PageSize >= huge_page_size ) {
+
+                // MEM_LARGE_PAGES, fails without the lock pages privilege...
+
+                void * const block = VirtualAlloc ( 0, ( unsigned long long ) size_, 0x00001000 | 0x00002000 | 0x20000000, 0x04 );
+
+                if ( nullptr != block ) {
+
+                    return reinterpret_cast<SlotPointer> ( block );
+                }
+            }
+
             return reinterpret_cast<SlotPointer> ( VirtualAlloc ( 0, ( unsigned long long ) size_, 0x00001000 | 0x00002000, 0x04 ) );
+#else
+            void * block = MAP_FAILED;
+
+            if constexpr ( PageSize >= huge_page_size ) {
+
+#if defined ( MAP_HUGETLB )
+                // Reserved huge pages (vm.nr_hugepages), if any are left...
+
+                block = mmap ( nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+#endif
+                if ( MAP_FAILED == block ) {
+
+                    // Transparent huge pages, these require a huge page aligned region, so
+                    // over-allocate and unmap the excess at both ends...
+
+                    const DataPtr region = reinterpret_cast<DataPtr> ( mmap ( nullptr, size_ + PageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) );
+
+                    if ( reinterpret_cast<DataPtr> ( MAP_FAILED ) != region ) {
+
+                        const size_type pad = pad_pointer ( region, PageSize );
+
+                        if ( pad ) {
+
+                            munmap ( region, pad );
+                        }
+
+                        munmap ( region + pad + size_, PageSize - pad );
+                        block = region + pad;
+#if defined ( MADV_HUGEPAGE )
+                        madvise ( block, size_, MADV_HUGEPAGE );
+#endif
+                    }
+                }
+            }
+
+            else {
+
+                block = mmap ( nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+            }
+
+            return MAP_FAILED != block ? reinterpret_cast<SlotPointer> ( block ) : nullptr;
+#endif
         }
 
 
@@ -395,7 +527,27 @@ namespace pa {
             chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::virtual_free ( const SlotPointer block_ )
             const noexcept
         {
+#if defined ( _WIN32 )
             VirtualFree ( reinterpret_cast< void* > ( block_ ), 0, 0x00008000 );
+#else
+            munmap ( reinterpret_cast< void* > ( block_ ), block_size ( ) );
+#endif
+        }
+
+
+
+        template<typename T, std::size_t ChunkCount, std::size_t PageSize, std::size_t MinAlloc>
+        inline bool
+            chunk_pool_allocator<T, ChunkCount, PageSize, MinAlloc>::virtual_release ( const DataPtr begin_, const DataPtr end_ )
+            const noexcept
+        {
+            // The pages stay mapped, their contents are discarded...
+
+#if defined ( _WIN32 )
+            return nullptr != VirtualAlloc ( reinterpret_cast< void* > ( begin_ ), ( unsigned long long ) ( end_ - begin_ ), 0x00080000, 0x04 );
+#else
+            return 0 == madvise ( reinterpret_cast< void* > ( begin_ ), end_ - begin_, MADV_DONTNEED );
+#endif
         }
 
 
@@ -0,0 +1,190 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+
+#include "player.hpp"
+
+
+namespace pc {
+
+    // A fixed-size cache of the rollout statistics of positions, keyed by the
+    // (zobrist) key of the position and the player that just moved, i.e. two
+    // engines playing each other, or many sessions of a host going through
+    // the same openings, share the rollouts of the positions they all meet.
+    // The score is of the player that just moved.
+    //
+    // The cache is lock-free: the 64-byte (cache line) buckets hold 4 entries
+    // of a key and the packed statistics (score and visits). A read takes the
+    // key, the statistics, and the key again, a read racing a replacement is a
+    // miss. A full bucket gives up the entry of the fewest visits. An add racing
+    // a replacement may credit the new position, the cache is a prior only, a
+    // lost or misplaced add costs some accuracy, never correctness.
+
+    class PositionCache {
+
+    public:
+
+        struct Stats {
+            float score = 0.0f;
+            std::int32_t visits = 0;
+        };
+
+        struct Counters {
+            std::uint64_t hits, misses;
+        };
+
+        static constexpr std::size_t default_bytes = 16u * 1'048'576u;
+
+    private:
+
+        static constexpr std::uint64_t empty_key = 0u; // The keys are odd.
+        static constexpr std::size_t bucket_size = 4u;
+
+        struct Entry {
+            std::atomic<std::uint64_t> key, stats;
+        };
+
+        struct alignas ( 64 ) Bucket {
+            Entry entries [ bucket_size ];
+        };
+
+        static_assert ( 64u == sizeof ( Bucket ), "a bucket is a cache line" );
+
+        std::unique_ptr<Bucket [ ]> m_buckets;
+        std::size_t m_no_buckets;
+
+        mutable std::atomic<std::uint64_t> m_hits { 0u }, m_misses { 0u };
+
+        // The player is mixed into the key (by a multiple of the golden ratio),
+        // the low half of the key maps onto the buckets by a multiply and shift.
+
+        [[ nodiscard ]] static std::uint64_t key ( const std::uint64_t zobrist_, const Player player_ ) noexcept {
+            return ( zobrist_ ^ ( std::uint64_t ) ( player_.as_index ( ) + 3 ) * 0x9e37'79b9'7f4a'7c15ull ) | 1u;
+        }
+
+        [[ nodiscard ]] Bucket & bucket ( const std::uint64_t key_ ) const noexcept {
+            return m_buckets [ ( key_ & 0xffff'ffffull ) * m_no_buckets >> 32 ];
+        }
+
+        [[ nodiscard ]] static std::uint64_t pack ( const Stats stats_ ) noexcept {
+            return ( std::uint64_t ) std::bit_cast<std::uint32_t> ( stats_.score ) << 32 | std::bit_cast<std::uint32_t> ( stats_.visits );
+        }
+
+        [[ nodiscard ]] static Stats unpack ( const std::uint64_t stats_ ) noexcept {
+            return { std::bit_cast<float> ( ( std::uint32_t ) ( stats_ >> 32 ) ), std::bit_cast<std::int32_t> ( ( std::uint32_t ) stats_ ) };
+        }
+
+    public:
+
+        // The cache takes bytes_ (in whole buckets, of 16 up to 2^32 buckets), all
+        // of it up front.
+
+        explicit PositionCache ( const std::size_t bytes_ = default_bytes ) :
+            m_no_buckets ( std::clamp ( bytes_ / sizeof ( Bucket ), std::size_t { 16 }, std::size_t { 1 } << 32 ) ) {
+            m_buckets = std::make_unique<Bucket [ ]> ( m_no_buckets );
+        }
+
+        PositionCache ( const PositionCache & ) = delete;
+        PositionCache & operator = ( const PositionCache & ) = delete;
+
+        // The statistics of the position, zero visits if not present.
+
+        [[ nodiscard ]] Stats find ( const std::uint64_t zobrist_, const Player player_just_moved_ ) const noexcept {
+            const std::uint64_t key = this->key ( zobrist_, player_just_moved_ );
+            const Bucket & bucket = this->bucket ( key );
+            for ( const Entry & entry : bucket.entries ) {
+                if ( key == entry.key.load ( std::memory_order_acquire ) ) {
+                    const std::uint64_t stats = entry.stats.load ( std::memory_order_acquire );
+                    if ( key == entry.key.load ( std::memory_order_acquire ) ) {
+                        m_hits.fetch_add ( 1u, std::memory_order_relaxed );
+                        return unpack ( stats );
+                    }
+                    break;
+                }
+            }
+            m_misses.fetch_add ( 1u, std::memory_order_relaxed );
+            return { };
+        }
+
+        // Adds score_ (of the player that just moved) over visits_ to the
+        // statistics of the position.
+
+        void add ( const std::uint64_t zobrist_, const Player player_just_moved_, const float score_, const std::int32_t visits_ ) noexcept {
+            const std::uint64_t key = this->key ( zobrist_, player_just_moved_ );
+            Bucket & bucket = this->bucket ( key );
+            Entry * victim = nullptr;
+            std::int32_t victim_visits = 0;
+            for ( Entry & entry : bucket.entries ) {
+                const std::uint64_t entry_key = entry.key.load ( std::memory_order_acquire );
+                if ( key == entry_key ) {
+                    std::uint64_t stats = entry.stats.load ( std::memory_order_relaxed );
+                    while ( not ( entry.stats.compare_exchange_weak ( stats, pack ( { unpack ( stats ).score + score_, unpack ( stats ).visits + visits_ } ), std::memory_order_acq_rel ) ) );
+                    return;
+                }
+                const std::int32_t visits = empty_key == entry_key ? -1 : unpack ( entry.stats.load ( std::memory_order_relaxed ) ).visits;
+                if ( nullptr == victim or visits < victim_visits ) {
+                    victim = & entry;
+                    victim_visits = visits;
+                }
+            }
+            // Take the entry (the key is emptied while the statistics are written),
+            // unless another add took it meanwhile.
+            std::uint64_t victim_key = victim->key.load ( std::memory_order_relaxed );
+            if ( empty_key != victim_key and not ( victim->key.compare_exchange_strong ( victim_key, empty_key, std::memory_order_acq_rel ) ) ) {
+                return;
+            }
+            victim->stats.store ( pack ( { score_, visits_ } ), std::memory_order_release );
+            victim->key.store ( key, std::memory_order_release );
+        }
+
+        [[ nodiscard ]] std::size_t memory ( ) const noexcept {
+            return sizeof ( PositionCache ) + m_no_buckets * sizeof ( Bucket );
+        }
+
+        [[ nodiscard ]] Counters counters ( ) const noexcept {
+            return { m_hits.load ( std::memory_order_relaxed ), m_misses.load ( std::memory_order_relaxed ) };
+        }
+
+        // Not thread-safe.
+
+        void clear ( ) noexcept {
+            for ( std::size_t b = 0u; b < m_no_buckets; ++b ) {
+                for ( Entry & entry : m_buckets [ b ].entries ) {
+                    entry.key.store ( empty_key, std::memory_order_relaxed );
+                }
+            }
+            m_hits.store ( 0u, std::memory_order_relaxed );
+            m_misses.store ( 0u, std::memory_order_relaxed );
+        }
+    };
+}
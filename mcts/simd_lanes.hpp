@@ -0,0 +1,284 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined ( __AVX512F__ ) || defined ( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+
+namespace sl {
+
+    // 8 lanes of 64 bits, for the bitboard kernels (f.e. batch playouts), in
+    // one AVX-512 register, in two AVX2 registers, or (the portable fallback)
+    // in an array. A lane mask has all bits of a lane set or none.
+
+    constexpr std::size_t lanes = 8u;
+
+#if defined ( __AVX512F__ ) || defined ( __AVX2__ )
+    constexpr bool vectorized = true;
+#else
+    constexpr bool vectorized = false; // The fallback is slower than a lane at a time.
+#endif
+
+    struct Lanes {
+
+#if defined ( __AVX512F__ )
+
+        __m512i v;
+
+        [[ nodiscard ]] static Lanes broadcast ( const std::uint64_t x_ ) noexcept {
+            return { _mm512_set1_epi64 ( ( long long ) x_ ) };
+        }
+
+        [[ nodiscard ]] static Lanes load ( const std::uint64_t * x_ ) noexcept {
+            return { _mm512_loadu_si512 ( x_ ) };
+        }
+
+        void store ( std::uint64_t * x_ ) const noexcept {
+            _mm512_storeu_si512 ( x_, v );
+        }
+
+        [[ nodiscard ]] friend Lanes operator & ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm512_and_si512 ( a_.v, b_.v ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator | ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm512_or_si512 ( a_.v, b_.v ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator ^ ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm512_xor_si512 ( a_.v, b_.v ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator + ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm512_add_epi64 ( a_.v, b_.v ) };
+        }
+
+        // ~a_ & b_.
+
+        [[ nodiscard ]] friend Lanes andNot ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm512_andnot_si512 ( a_.v, b_.v ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator >> ( const Lanes a_, const unsigned n_ ) noexcept {
+            return { _mm512_srli_epi64 ( a_.v, n_ ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator << ( const Lanes a_, const unsigned n_ ) noexcept {
+            return { _mm512_slli_epi64 ( a_.v, n_ ) };
+        }
+
+        // Each lane shifted by the count in the lane of n_.
+
+        [[ nodiscard ]] friend Lanes operator << ( const Lanes a_, const Lanes n_ ) noexcept {
+            return { _mm512_sllv_epi64 ( a_.v, n_.v ) };
+        }
+
+        // The low 32 bits of each lane times n_, in 64 bits.
+
+        [[ nodiscard ]] friend Lanes mul32 ( const Lanes a_, const std::uint32_t n_ ) noexcept {
+            return { _mm512_mul_epu32 ( a_.v, _mm512_set1_epi64 ( n_ ) ) };
+        }
+
+        // The lane mask of the lanes that are zero.
+
+        [[ nodiscard ]] friend Lanes isZero ( const Lanes a_ ) noexcept {
+            return { _mm512_maskz_mov_epi64 ( _mm512_testn_epi64_mask ( a_.v, a_.v ), _mm512_set1_epi64 ( -1 ) ) };
+        }
+
+        // A bit per lane, set if the lane is not zero.
+
+        [[ nodiscard ]] friend std::uint32_t bits ( const Lanes a_ ) noexcept {
+            return _mm512_test_epi64_mask ( a_.v, a_.v );
+        }
+
+#elif defined ( __AVX2__ )
+
+        __m256i lo, hi;
+
+        [[ nodiscard ]] static Lanes broadcast ( const std::uint64_t x_ ) noexcept {
+            const __m256i x = _mm256_set1_epi64x ( ( long long ) x_ );
+            return { x, x };
+        }
+
+        [[ nodiscard ]] static Lanes load ( const std::uint64_t * x_ ) noexcept {
+            return { _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( x_ ) ), _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( x_ + 4 ) ) };
+        }
+
+        void store ( std::uint64_t * x_ ) const noexcept {
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( x_ ), lo );
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( x_ + 4 ), hi );
+        }
+
+        [[ nodiscard ]] friend Lanes operator & ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm256_and_si256 ( a_.lo, b_.lo ), _mm256_and_si256 ( a_.hi, b_.hi ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator | ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm256_or_si256 ( a_.lo, b_.lo ), _mm256_or_si256 ( a_.hi, b_.hi ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator ^ ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm256_xor_si256 ( a_.lo, b_.lo ), _mm256_xor_si256 ( a_.hi, b_.hi ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator + ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm256_add_epi64 ( a_.lo, b_.lo ), _mm256_add_epi64 ( a_.hi, b_.hi ) };
+        }
+
+        [[ nodiscard ]] friend Lanes andNot ( const Lanes a_, const Lanes b_ ) noexcept {
+            return { _mm256_andnot_si256 ( a_.lo, b_.lo ), _mm256_andnot_si256 ( a_.hi, b_.hi ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator >> ( const Lanes a_, const unsigned n_ ) noexcept {
+            return { _mm256_srli_epi64 ( a_.lo, n_ ), _mm256_srli_epi64 ( a_.hi, n_ ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator << ( const Lanes a_, const unsigned n_ ) noexcept {
+            return { _mm256_slli_epi64 ( a_.lo, n_ ), _mm256_slli_epi64 ( a_.hi, n_ ) };
+        }
+
+        [[ nodiscard ]] friend Lanes operator << ( const Lanes a_, const Lanes n_ ) noexcept {
+            return { _mm256_sllv_epi64 ( a_.lo, n_.lo ), _mm256_sllv_epi64 ( a_.hi, n_.hi ) };
+        }
+
+        [[ nodiscard ]] friend Lanes mul32 ( const Lanes a_, const std::uint32_t n_ ) noexcept {
+            const __m256i n = _mm256_set1_epi64x ( n_ );
+            return { _mm256_mul_epu32 ( a_.lo, n ), _mm256_mul_epu32 ( a_.hi, n ) };
+        }
+
+        [[ nodiscard ]] friend Lanes isZero ( const Lanes a_ ) noexcept {
+            const __m256i zero = _mm256_setzero_si256 ( );
+            return { _mm256_cmpeq_epi64 ( a_.lo, zero ), _mm256_cmpeq_epi64 ( a_.hi, zero ) };
+        }
+
+        [[ nodiscard ]] friend std::uint32_t bits ( const Lanes a_ ) noexcept {
+            const Lanes zero = isZero ( a_ );
+            return ~( ( std::uint32_t ) _mm256_movemask_pd ( _mm256_castsi256_pd ( zero.lo ) ) | ( std::uint32_t ) _mm256_movemask_pd ( _mm256_castsi256_pd ( zero.hi ) ) << 4 ) & 0xffu;
+        }
+
+#else
+
+        std::uint64_t v [ lanes ];
+
+        template<typename Function>
+        [[ nodiscard ]] static Lanes map ( Function && function_ ) noexcept {
+            Lanes r;
+            for ( std::size_t l = 0u; l < lanes; ++l ) {
+                r.v [ l ] = function_ ( l );
+            }
+            return r;
+        }
+
+        [[ nodiscard ]] static Lanes broadcast ( const std::uint64_t x_ ) noexcept {
+            return map ( [ x_ ] ( std::size_t ) { return x_; } );
+        }
+
+        [[ nodiscard ]] static Lanes load ( const std::uint64_t * x_ ) noexcept {
+            return map ( [ x_ ] ( const std::size_t l_ ) { return x_ [ l_ ]; } );
+        }
+
+        void store ( std::uint64_t * x_ ) const noexcept {
+            for ( std::size_t l = 0u; l < lanes; ++l ) {
+                x_ [ l ] = v [ l ];
+            }
+        }
+
+        [[ nodiscard ]] friend Lanes operator & ( const Lanes a_, const Lanes b_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return a_.v [ l_ ] & b_.v [ l_ ]; } );
+        }
+
+        [[ nodiscard ]] friend Lanes operator | ( const Lanes a_, const Lanes b_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return a_.v [ l_ ] | b_.v [ l_ ]; } );
+        }
+
+        [[ nodiscard ]] friend Lanes operator ^ ( const Lanes a_, const Lanes b_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return a_.v [ l_ ] ^ b_.v [ l_ ]; } );
+        }
+
+        [[ nodiscard ]] friend Lanes operator + ( const Lanes a_, const Lanes b_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return a_.v [ l_ ] + b_.v [ l_ ]; } );
+        }
+
+        [[ nodiscard ]] friend Lanes andNot ( const Lanes a_, const Lanes b_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return ~a_.v [ l_ ] & b_.v [ l_ ]; } );
+        }
+
+        [[ nodiscard ]] friend Lanes operator >> ( const Lanes a_, const unsigned n_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return a_.v [ l_ ] >> n_; } );
+        }
+
+        [[ nodiscard ]] friend Lanes operator << ( const Lanes a_, const unsigned n_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return a_.v [ l_ ] << n_; } );
+        }
+
+        [[ nodiscard ]] friend Lanes operator << ( const Lanes a_, const Lanes n_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return n_.v [ l_ ] < 64u ? a_.v [ l_ ] << n_.v [ l_ ] : std::uint64_t { 0 }; } );
+        }
+
+        [[ nodiscard ]] friend Lanes mul32 ( const Lanes a_, const std::uint32_t n_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return ( std::uint64_t ) ( std::uint32_t ) a_.v [ l_ ] * n_; } );
+        }
+
+        [[ nodiscard ]] friend Lanes isZero ( const Lanes a_ ) noexcept {
+            return map ( [ & ] ( const std::size_t l_ ) { return 0u == a_.v [ l_ ] ? ~std::uint64_t { 0 } : std::uint64_t { 0 }; } );
+        }
+
+        [[ nodiscard ]] friend std::uint32_t bits ( const Lanes a_ ) noexcept {
+            std::uint32_t b = 0u;
+            for ( std::size_t l = 0u; l < lanes; ++l ) {
+                b |= std::uint32_t { 0u != a_.v [ l ] } << l;
+            }
+            return b;
+        }
+
+#endif
+
+        [[ nodiscard ]] static Lanes zero ( ) noexcept {
+            return broadcast ( 0u );
+        }
+
+        // (( a_ >> 32 ) * n_ ) >> 32, i.e. the high half of each lane mapped onto
+        // [ 0, n_ ).
+
+        [[ nodiscard ]] friend Lanes bounded ( const Lanes a_, const std::uint32_t n_ ) noexcept {
+            return mul32 ( a_ >> 32u, n_ ) >> 32u;
+        }
+
+        // A step of the xorshift64 generator (13, 7, 17) in each lane, the lanes
+        // must not be zero.
+
+        Lanes & next ( ) noexcept {
+            * this = * this ^ ( * this << 13u );
+            * this = * this ^ ( * this >> 7u );
+            * this = * this ^ ( * this << 17u );
+            return * this;
+        }
+    };
+}
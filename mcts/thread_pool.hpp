@@ -0,0 +1,200 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Typedefs.hpp"
+#include "topology.hpp"
+
+
+namespace tp {
+
+    // A fixed size pool of worker threads with work-stealing. Every worker owns
+    // a task deque, tasks submitted from a worker go to the back of its own
+    // deque and are popped LIFO, tasks submitted from outside the pool are
+    // distributed round-robin. An idle worker steals from the front of the
+    // deques of the other workers, before going to sleep.
+
+    class ThreadPool {
+
+        using Task = std::function<void ( )>;
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::thread> m_threads;
+        std::unique_ptr<Queue [ ]> m_queues;
+        index_t m_no_queues = 0;
+        std::atomic<index_t> m_next_queue { 0 };
+        std::atomic<std::int64_t> m_no_pending { 0 };
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stop = false;
+
+        // The pool and the queue index of the current thread, if it's a worker.
+
+        static inline thread_local const ThreadPool * t_pool = nullptr;
+        static inline thread_local index_t t_queue = 0;
+
+        [[ nodiscard ]] bool pop ( const index_t queue_, Task & task_ ) noexcept {
+            Queue & queue = m_queues [ queue_ ];
+            std::lock_guard<std::mutex> lock ( queue.mutex );
+            if ( queue.tasks.empty ( ) ) {
+                return false;
+            }
+            task_ = std::move ( queue.tasks.back ( ) );
+            queue.tasks.pop_back ( );
+            return true;
+        }
+
+        [[ nodiscard ]] bool steal ( const index_t queue_, Task & task_ ) noexcept {
+            for ( index_t i = 1; i < m_no_queues; ++i ) {
+                Queue & queue = m_queues [ ( queue_ + i ) % m_no_queues ];
+                std::unique_lock<std::mutex> lock ( queue.mutex, std::try_to_lock );
+                if ( lock.owns_lock ( ) and not ( queue.tasks.empty ( ) ) ) {
+                    task_ = std::move ( queue.tasks.front ( ) );
+                    queue.tasks.pop_front ( );
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work ( const index_t queue_, const topo::Pinning pinning_ ) noexcept {
+            topo::pin ( queue_, pinning_ );
+            t_pool = this;
+            t_queue = queue_;
+            while ( true ) {
+                Task task;
+                if ( pop ( queue_, task ) or steal ( queue_, task ) ) {
+                    m_no_pending.fetch_sub ( 1, std::memory_order_relaxed );
+                    task ( );
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock ( m_mutex );
+                m_condition.wait ( lock, [ this ] ( ) { return m_stop or m_no_pending.load ( std::memory_order_relaxed ) > 0; } );
+                if ( m_stop and 0 == m_no_pending.load ( std::memory_order_relaxed ) ) { // Nothing left to do.
+                    return;
+                }
+            }
+        }
+
+    public:
+
+        explicit ThreadPool ( const index_t no_threads_ = topo::usableCores ( ), const topo::Pinning pinning_ = topo::Pinning::none ) :
+            m_queues ( std::make_unique<Queue [ ]> ( no_threads_ > 0 ? no_threads_ : 1 ) ),
+            m_no_queues ( no_threads_ > 0 ? no_threads_ : 1 ) {
+            m_threads.reserve ( m_no_queues );
+            for ( index_t i = 0; i < m_no_queues; ++i ) {
+                m_threads.emplace_back ( [ this, i, pinning_ ] ( ) { work ( i, pinning_ ); } );
+            }
+        }
+
+        ThreadPool ( const ThreadPool & ) = delete;
+        ThreadPool & operator = ( const ThreadPool & ) = delete;
+
+        ~ThreadPool ( ) noexcept {
+            {
+                std::lock_guard<std::mutex> lock ( m_mutex );
+                m_stop = true;
+            }
+            m_condition.notify_all ( );
+            for ( std::thread & thread : m_threads ) {
+                thread.join ( );
+            }
+        }
+
+        [[ nodiscard ]] index_t size ( ) const noexcept {
+            return ( index_t ) m_threads.size ( );
+        }
+
+        // Runs a pending task on the calling thread, the last task of its own
+        // queue (if it's a worker) or else the first task found in any queue.
+        // Returns false if no task was pending, i.e. every task submitted so far
+        // has been taken by a thread. A thread waiting for a task of the pool
+        // helps out, instead of blocking a worker on a task that is queued.
+
+        [[ maybe_unused ]] bool runPending ( ) {
+            Task task;
+            const bool worker = this == t_pool;
+            const index_t first = worker ? t_queue : 0;
+            for ( index_t i = 0; i < m_no_queues; ++i ) {
+                Queue & queue = m_queues [ ( first + i ) % m_no_queues ];
+                {
+                    std::lock_guard<std::mutex> lock ( queue.mutex );
+                    if ( queue.tasks.empty ( ) ) {
+                        continue;
+                    }
+                    if ( worker and 0 == i ) {
+                        task = std::move ( queue.tasks.back ( ) );
+                        queue.tasks.pop_back ( );
+                    }
+                    else {
+                        task = std::move ( queue.tasks.front ( ) );
+                        queue.tasks.pop_front ( );
+                    }
+                }
+                m_no_pending.fetch_sub ( 1, std::memory_order_relaxed );
+                task ( );
+                return true;
+            }
+            return false;
+        }
+
+        template<typename Function>
+        [[ nodiscard ]] std::future<std::invoke_result_t<Function>> submit ( Function && function_ ) {
+            using Result = std::invoke_result_t<Function>;
+            // std::function requires a copyable target, hence the shared_ptr.
+            auto task = std::make_shared<std::packaged_task<Result ( )>> ( std::forward<Function> ( function_ ) );
+            std::future<Result> future = task->get_future ( );
+            const index_t queue_index = this == t_pool ? t_queue : m_next_queue.fetch_add ( 1, std::memory_order_relaxed ) % m_no_queues;
+            {
+                Queue & queue = m_queues [ queue_index ];
+                std::lock_guard<std::mutex> lock ( queue.mutex );
+                queue.tasks.emplace_back ( [ task ] ( ) { ( * task ) ( ); } );
+            }
+            {
+                // Under the lock, a worker can't miss the wake-up between its check and its wait.
+                std::lock_guard<std::mutex> lock ( m_mutex );
+                m_no_pending.fetch_add ( 1, std::memory_order_relaxed );
+            }
+            m_condition.notify_one ( );
+            return future;
+        }
+    };
+}
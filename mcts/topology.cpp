@@ -0,0 +1,329 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#if defined ( _WIN32 )
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "topology.hpp"
+
+
+namespace topo {
+
+    namespace {
+
+        // Returns the index of key_ in keys_, the key is appended if not present.
+
+        template<typename Key>
+        [[ nodiscard ]] index_t indexOf ( std::vector<Key> & keys_, const Key & key_ ) noexcept {
+            const auto it = std::find ( keys_.cbegin ( ), keys_.cend ( ), key_ );
+            if ( keys_.cend ( ) != it ) {
+                return ( index_t ) ( it - keys_.cbegin ( ) );
+            }
+            keys_.push_back ( key_ );
+            return ( index_t ) keys_.size ( ) - 1;
+        }
+
+#ifndef _WIN32
+
+        [[ nodiscard ]] std::string readLine ( const std::string & path_ ) noexcept {
+            std::ifstream stream ( path_ );
+            std::string line;
+            std::getline ( stream, line );
+            return line;
+        }
+
+        [[ nodiscard ]] index_t readIndex ( const std::string & path_, const index_t default_ ) noexcept {
+            const std::string line = readLine ( path_ );
+            return line.empty ( ) ? default_ : ( index_t ) std::atoi ( line.c_str ( ) );
+        }
+
+        // The cgroup of this process (from /proc/self/cgroup), in the v2 hierarchy
+        // for an empty controller_, else in the v1 hierarchy of controller_.
+
+        [[ nodiscard ]] std::string cgroupOf ( const std::string & controller_ ) noexcept {
+            std::ifstream stream ( "/proc/self/cgroup" );
+            std::string line;
+            while ( std::getline ( stream, line ) ) { // "<id>:<controllers>:<path>".
+                const std::size_t first = line.find ( ':' ), second = line.find ( ':', first + 1 );
+                if ( std::string::npos == first or std::string::npos == second ) {
+                    continue;
+                }
+                const std::string controllers = "," + line.substr ( first + 1, second - first - 1 ) + ",";
+                if ( controller_.empty ( ) ? 2u == controllers.size ( ) : std::string::npos != controllers.find ( "," + controller_ + "," ) ) {
+                    return line.substr ( second + 1 );
+                }
+            }
+            return "/";
+        }
+
+        // The lowest of the quotas ( directory ) of cgroup_ (under the mount point
+        // root_) and of its ancestors, 0 if none has a limit. A limit on a parent
+        // applies to its children. The levels not visible here (a container
+        // mounts its own cgroup as the root) have no files, and no limit.
+
+        template<typename Quota>
+        [[ nodiscard ]] index_t lowestQuota ( const std::string & root_, std::string cgroup_, Quota quota_ ) noexcept {
+            index_t lowest = 0;
+            while ( true ) {
+                const index_t quota = quota_ ( root_ + cgroup_ );
+                if ( quota and ( not ( lowest ) or quota < lowest ) ) {
+                    lowest = quota;
+                }
+                if ( cgroup_.empty ( ) ) {
+                    return lowest;
+                }
+                cgroup_.resize ( cgroup_.rfind ( '/' ) ); // "/a/b", "/a", "".
+            }
+        }
+
+        // The cgroup (v2, then v1) cpu quota, in cpus rounded up, 0 if there's no limit.
+
+        [[ nodiscard ]] index_t cgroupQuota ( ) noexcept {
+            const auto quota = [ ] ( const double quota_, const double period_ ) noexcept {
+                return quota_ > 0.0 and period_ > 0.0 ? std::max ( ( index_t ) ( ( quota_ + period_ - 1.0 ) / period_ ), index_t { 1 } ) : index_t { 0 };
+            };
+            const auto v2 = [ & quota ] ( const std::string & directory_ ) noexcept {
+                const std::string line = readLine ( directory_ + "/cpu.max" ); // "max 100000" or "<quota> <period>".
+                const std::size_t space = line.find ( ' ' );
+                return line.empty ( ) or 0 == line.rfind ( "max", 0 ) or std::string::npos == space ? index_t { 0 } : quota ( std::atof ( line.c_str ( ) ), std::atof ( line.c_str ( ) + space ) );
+            };
+            const auto v1 = [ & quota ] ( const std::string & directory_ ) noexcept { // A quota of -1 is no limit.
+                return quota ( std::atof ( readLine ( directory_ + "/cpu.cfs_quota_us" ).c_str ( ) ), std::atof ( readLine ( directory_ + "/cpu.cfs_period_us" ).c_str ( ) ) );
+            };
+            if ( const index_t lowest = lowestQuota ( "/sys/fs/cgroup", cgroupOf ( "" ), v2 ) ) {
+                return lowest;
+            }
+            const std::string cgroup = cgroupOf ( "cpu" );
+            for ( const char * root : { "/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct" } ) {
+                if ( const index_t lowest = lowestQuota ( root, cgroup, v1 ) ) {
+                    return lowest;
+                }
+            }
+            return 0;
+        }
+
+#endif
+    }
+
+
+#if defined ( _WIN32 )
+
+    Topology::Topology ( ) noexcept {
+        DWORD_PTR process_mask = 0, system_mask = 0;
+        if ( not ( GetProcessAffinityMask ( GetCurrentProcess ( ), & process_mask, & system_mask ) ) ) {
+            process_mask = 1;
+        }
+        DWORD size = 0;
+        GetLogicalProcessorInformation ( nullptr, & size );
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info ( size / sizeof ( SYSTEM_LOGICAL_PROCESSOR_INFORMATION ) );
+        if ( info.empty ( ) or not ( GetLogicalProcessorInformation ( info.data ( ), & size ) ) ) {
+            info.clear ( );
+        }
+        std::vector<ULONG_PTR> packages, cores, l2s, l3s;
+        for ( index_t id = 0; id < ( index_t ) ( 8 * sizeof ( DWORD_PTR ) ); ++id ) {
+            const ULONG_PTR bit = ULONG_PTR { 1 } << id;
+            if ( not ( process_mask & bit ) ) {
+                continue;
+            }
+            // Without the information, every processor is a core of its own.
+            Cpu cpu { id, 0, 0, 0, 0 };
+            ULONG_PTR core_mask = bit, l2_mask = bit, l3_mask = 0;
+            for ( const SYSTEM_LOGICAL_PROCESSOR_INFORMATION & i : info ) {
+                if ( not ( i.ProcessorMask & bit ) ) {
+                    continue;
+                }
+                switch ( i.Relationship ) {
+                    case RelationProcessorPackage: cpu.package = indexOf ( packages, i.ProcessorMask ); break;
+                    case RelationProcessorCore: core_mask = i.ProcessorMask; break;
+                    case RelationCache:
+                        if ( CacheInstruction != i.Cache.Type ) {
+                            if ( 2 == i.Cache.Level ) {
+                                l2_mask = i.ProcessorMask;
+                            }
+                            else if ( 3 == i.Cache.Level ) {
+                                l3_mask = i.ProcessorMask;
+                            }
+                        }
+                        break;
+                    default: break;
+                }
+            }
+            cpu.core = indexOf ( cores, core_mask );
+            cpu.l2 = indexOf ( l2s, l2_mask );
+            cpu.l3 = indexOf ( l3s, l3_mask );
+            m_cpus.push_back ( cpu );
+        }
+        m_no_cores = ( index_t ) cores.size ( );
+        m_no_l2 = ( index_t ) l2s.size ( );
+        m_no_l3 = ( index_t ) l3s.size ( );
+        order ( );
+    }
+
+#else
+
+    Topology::Topology ( ) noexcept {
+        cpu_set_t set;
+        CPU_ZERO ( & set );
+        if ( sched_getaffinity ( 0, sizeof ( set ), & set ) ) {
+            CPU_ZERO ( & set );
+            CPU_SET ( 0, & set );
+        }
+        std::vector<std::pair<index_t, index_t>> cores;
+        std::vector<std::string> l2s, l3s;
+        for ( index_t id = 0; id < CPU_SETSIZE; ++id ) {
+            if ( not ( CPU_ISSET ( id, & set ) ) ) {
+                continue;
+            }
+            const std::string path = "/sys/devices/system/cpu/cpu" + std::to_string ( id ) + "/";
+            // Without sysfs, every processor is a core of its own.
+            Cpu cpu { id, readIndex ( path + "topology/physical_package_id", 0 ), 0, 0, 0 };
+            cpu.core = indexOf ( cores, { cpu.package, readIndex ( path + "topology/core_id", id ) } );
+            std::string l2 = std::to_string ( id ), l3;
+            for ( index_t i = 0; i < 8; ++i ) {
+                const std::string cache = path + "cache/index" + std::to_string ( i ) + "/";
+                const index_t level = readIndex ( cache + "level", 0 );
+                if ( 0 == level ) {
+                    break;
+                }
+                if ( "Instruction" == readLine ( cache + "type" ) ) {
+                    continue;
+                }
+                if ( 2 == level ) {
+                    l2 = readLine ( cache + "shared_cpu_list" );
+                }
+                else if ( 3 == level ) {
+                    l3 = readLine ( cache + "shared_cpu_list" );
+                }
+            }
+            cpu.l2 = indexOf ( l2s, l2 );
+            cpu.l3 = indexOf ( l3s, l3 );
+            m_cpus.push_back ( cpu );
+        }
+        m_no_cores = ( index_t ) cores.size ( );
+        m_no_l2 = ( index_t ) l2s.size ( );
+        m_no_l3 = ( index_t ) l3s.size ( );
+        m_quota = cgroupQuota ( );
+        order ( );
+    }
+
+#endif
+
+
+    void Topology::order ( ) noexcept {
+        const index_t n = ( index_t ) m_cpus.size ( );
+        // The rank of a processor among its SMT siblings, and the rank of its core
+        // among the cores of its l3 domain.
+        std::vector<index_t> smt_rank ( n ), core_rank ( n );
+        for ( index_t i = 0; i < n; ++i ) {
+            std::vector<index_t> l3_cores;
+            for ( index_t j = 0; j < n; ++j ) {
+                if ( m_cpus [ j ].core == m_cpus [ i ].core and m_cpus [ j ].id < m_cpus [ i ].id ) {
+                    ++smt_rank [ i ];
+                }
+                if ( m_cpus [ j ].l3 == m_cpus [ i ].l3 and m_cpus [ j ].core < m_cpus [ i ].core ) {
+                    ( void ) indexOf ( l3_cores, m_cpus [ j ].core );
+                }
+            }
+            core_rank [ i ] = ( index_t ) l3_cores.size ( );
+        }
+        m_compact.resize ( n );
+        std::iota ( m_compact.begin ( ), m_compact.end ( ), 0 );
+        m_scatter = m_compact;
+        std::sort ( m_compact.begin ( ), m_compact.end ( ), [ this ] ( const index_t a_, const index_t b_ ) {
+            const Cpu & a = m_cpus [ a_ ], & b = m_cpus [ b_ ];
+            return std::tie ( a.package, a.l3, a.l2, a.core, a.id ) < std::tie ( b.package, b.l3, b.l2, b.core, b.id );
+        } );
+        std::sort ( m_scatter.begin ( ), m_scatter.end ( ), [ this, & smt_rank, & core_rank ] ( const index_t a_, const index_t b_ ) {
+            const Cpu & a = m_cpus [ a_ ], & b = m_cpus [ b_ ];
+            return std::tie ( smt_rank [ a_ ], core_rank [ a_ ], a.l3, a.id ) < std::tie ( smt_rank [ b_ ], core_rank [ b_ ], b.l3, b.id );
+        } );
+    }
+
+
+    [[ nodiscard ]] const Topology & Topology::instance ( ) noexcept {
+        static const Topology topology;
+        return topology;
+    }
+
+
+    [[ nodiscard ]] index_t Topology::usableCores ( ) const noexcept {
+        const index_t no_cpus = std::max ( ( index_t ) m_cpus.size ( ), index_t { 1 } );
+        return m_quota > 0 ? std::min ( no_cpus, m_quota ) : no_cpus;
+    }
+
+
+    [[ nodiscard ]] index_t Topology::smtSiblings ( const index_t cpu_ ) const noexcept {
+        const auto it = std::find_if ( m_cpus.cbegin ( ), m_cpus.cend ( ), [ cpu_ ] ( const Cpu & c_ ) { return cpu_ == c_.id; } );
+        if ( m_cpus.cend ( ) == it ) {
+            return 0;
+        }
+        return ( index_t ) std::count_if ( m_cpus.cbegin ( ), m_cpus.cend ( ), [ it ] ( const Cpu & c_ ) { return it->core == c_.core; } ) - 1;
+    }
+
+
+    [[ nodiscard ]] index_t Topology::cpuFor ( const index_t i_, const Pinning pinning_ ) const noexcept {
+        if ( m_cpus.empty ( ) ) {
+            return 0;
+        }
+        const std::vector<index_t> & order = Pinning::compact == pinning_ ? m_compact : m_scatter;
+        // Wraps around, with more workers than usable cores.
+        return m_cpus [ order [ i_ % std::min ( ( index_t ) order.size ( ), usableCores ( ) ) ] ].id;
+    }
+
+
+    void Topology::print ( ) const noexcept {
+        std::printf ( " Topology: %i usable cores (%i logical, cgroup quota %i), %i physical cores, %i l2 domains, %i l3 domains\n", usableCores ( ), ( index_t ) m_cpus.size ( ), m_quota, m_no_cores, m_no_l2, m_no_l3 );
+    }
+
+
+    [[ maybe_unused ]] bool pin ( const index_t i_, const Pinning pinning_ ) noexcept {
+        if ( Pinning::none == pinning_ ) {
+            return false;
+        }
+        const index_t cpu = Topology::instance ( ).cpuFor ( i_, pinning_ );
+#if defined ( _WIN32 )
+        return 0 != SetThreadAffinityMask ( GetCurrentThread ( ), DWORD_PTR { 1 } << cpu );
+#else
+        cpu_set_t set;
+        CPU_ZERO ( & set );
+        CPU_SET ( cpu, & set );
+        return 0 == pthread_setaffinity_np ( pthread_self ( ), sizeof ( set ), & set );
+#endif
+    }
+}
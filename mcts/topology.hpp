@@ -0,0 +1,105 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+
+#include <thread>
+#include <vector>
+
+#include "Typedefs.hpp"
+
+
+namespace topo {
+
+    // A usable logical processor, i.e. one in the affinity mask of the process.
+    // The core, l2 and l3 are indices of the physical core and of the cache
+    // domains, logical processors with the same core are SMT siblings.
+
+    struct Cpu {
+        index_t id = 0, package = 0, core = 0, l2 = 0, l3 = 0;
+    };
+
+    // How worker threads are pinned to the logical processors. Compact fills
+    // the SMT siblings of a core, and the cores of a cache domain, first, i.e.
+    // workers share caches. Scatter places one worker per physical core, spread
+    // over the l3 domains, before it places any SMT siblings.
+
+    enum class Pinning : std::int32_t { none, compact, scatter };
+
+    class Topology {
+
+        std::vector<Cpu> m_cpus;
+        std::vector<index_t> m_compact, m_scatter; // Indices into m_cpus, in pinning order.
+        index_t m_no_cores = 0, m_no_l2 = 0, m_no_l3 = 0, m_quota = 0;
+
+        Topology ( ) noexcept;
+
+        void order ( ) noexcept;
+
+    public:
+
+        [[ nodiscard ]] static const Topology & instance ( ) noexcept;
+
+        [[ nodiscard ]] const std::vector<Cpu> & cpus ( ) const noexcept {
+            return m_cpus;
+        }
+
+        // The number of threads that can run concurrently, the number of logical
+        // processors in the affinity mask, limited by the cgroup cpu quota.
+
+        [[ nodiscard ]] index_t usableCores ( ) const noexcept;
+
+        [[ nodiscard ]] index_t physicalCores ( ) const noexcept {
+            return m_no_cores;
+        }
+
+        [[ nodiscard ]] index_t smtSiblings ( const index_t cpu_ ) const noexcept;
+
+        [[ nodiscard ]] index_t l2Domains ( ) const noexcept {
+            return m_no_l2;
+        }
+
+        [[ nodiscard ]] index_t l3Domains ( ) const noexcept {
+            return m_no_l3;
+        }
+
+        // The logical processor (its id) of the i-th worker, under pinning_.
+
+        [[ nodiscard ]] index_t cpuFor ( const index_t i_, const Pinning pinning_ ) const noexcept;
+
+        void print ( ) const noexcept;
+    };
+
+
+    [[ nodiscard ]] inline index_t usableCores ( ) noexcept {
+        return Topology::instance ( ).usableCores ( );
+    }
+
+    // Pins the calling thread, as the i-th worker, returns false if pinning_ is
+    // none or the affinity could not be set.
+
+    [[ maybe_unused ]] bool pin ( const index_t i_, const Pinning pinning_ ) noexcept;
+}
@@ -0,0 +1,429 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <cereal/cereal.hpp>
+
+
+namespace tt {
+
+    // A fixed-size hash table of 64-bit (zobrist) keys, of 64-byte (cache line)
+    // buckets of 7 entries. An entry packs a 32-bit fragment of the key with
+    // the (32-bit) value in one atomic word, i.e. lookups and inserts are
+    // lock-free (a compare-and-swap per entry, there is no rehash and no
+    // mutex) and a lookup touches one cache line. The bucket index (from the
+    // low half of the key) and the fragment (the high half) verify about 31 +
+    // log2 ( buckets ) bits of the key.
+    //
+    // The entries carry the generation they were written in. A new generation
+    // (after a prune, see nextGeneration ( )) costs O ( 1 ), the table is never
+    // swept (but for a wrap of the generation, once in 256 generations). The
+    // entries of older generations are handed to the caller's validate_ (
+    // value, generation ) as a probe meets them: it returns whether the entry
+    // is still good, and may renumber the value. A good entry is revived, i.e.
+    // written back in the current generation, a stale one is recycled. Without
+    // a validate_ the older entries are all stale.
+    //
+    // The table is bounded: an insert into a full bucket (no empty or stale
+    // entries) replaces the entry of the lowest weight (as given by the caller,
+    // e.g. the visits of the node). A lost entry costs a missed transposition
+    // only. The table counts its hits, misses and collisions (the good entries
+    // replaced).
+    //
+    // Inserts of the same key racing on a full bucket may both succeed, the
+    // functions from clear ( ) on require exclusive access.
+
+    template<typename Key, typename Value>
+    class TranspositionTable {
+
+        static_assert ( std::is_trivially_copyable_v<Value> and 4u == sizeof ( Value ), "a value is packed with a key fragment in 64 bits" );
+
+        using Entry = std::uint64_t;
+
+        static constexpr Entry empty_entry = 0u; // The fragments are odd.
+        static constexpr std::size_t bucket_size = 7u;
+
+        struct alignas ( 64 ) Bucket {
+            std::atomic<Entry> entries [ bucket_size ];
+            std::atomic<std::uint8_t> generations [ bucket_size ];
+        };
+
+        static_assert ( 64u == sizeof ( Bucket ), "a bucket is a cache line" );
+
+        std::unique_ptr<Bucket [ ]> m_buckets;
+        std::size_t m_no_buckets;
+        mutable std::atomic<std::size_t> m_size { 0u };
+        Value m_invalid;
+        std::uint8_t m_generation = 0u;
+
+        mutable std::atomic<std::uint64_t> m_hits { 0u }, m_misses { 0u }, m_collisions { 0u };
+
+        // The zobrist keys are random already, the low half of the key is mapped
+        // onto the buckets by a multiply and shift (any number of buckets), the
+        // fragment is the high half (made odd).
+
+        [[ nodiscard ]] std::size_t index ( const Key key_ ) const noexcept {
+            return ( ( std::uint64_t ) key_ & 0xffff'ffffull ) * m_no_buckets >> 32;
+        }
+
+        [[ nodiscard ]] Bucket & bucket ( const Key key_ ) const noexcept {
+            return m_buckets [ index ( key_ ) ];
+        }
+
+        [[ nodiscard ]] static std::uint32_t fragment ( const Key key_ ) noexcept {
+            return ( std::uint32_t ) ( ( std::uint64_t ) key_ >> 32 ) | 1u;
+        }
+
+        [[ nodiscard ]] static Entry pack ( const std::uint32_t fragment_, const Value value_ ) noexcept {
+            return ( Entry ) fragment_ << 32 | std::bit_cast<std::uint32_t> ( value_ );
+        }
+
+        [[ nodiscard ]] static std::uint32_t fragmentOf ( const Entry entry_ ) noexcept {
+            return ( std::uint32_t ) ( entry_ >> 32 );
+        }
+
+        [[ nodiscard ]] static Value valueOf ( const Entry entry_ ) noexcept {
+            return std::bit_cast<Value> ( ( std::uint32_t ) entry_ );
+        }
+
+        // Reads entry i_ with its generation. A write empties the entry before it
+        // sets the generation, the generation is read on both sides of the entry,
+        // a torn read gives an empty entry.
+
+        [[ nodiscard ]] static Entry read ( const Bucket & bucket_, const std::size_t i_, std::uint8_t & generation_ ) noexcept {
+            generation_ = bucket_.generations [ i_ ].load ( std::memory_order_acquire );
+            const Entry entry = bucket_.entries [ i_ ].load ( std::memory_order_acquire );
+            return generation_ == bucket_.generations [ i_ ].load ( std::memory_order_acquire ) ? entry : empty_entry;
+        }
+
+        // Replaces entry i_ (if it still holds expected_) by entry_ of the current
+        // generation: empty the entry, set the generation, then fill the entry,
+        // unless another insert took it meanwhile.
+
+        [[ nodiscard ]] bool write ( Bucket & bucket_, const std::size_t i_, Entry expected_, const Entry entry_ ) const noexcept {
+            if ( not bucket_.entries [ i_ ].compare_exchange_strong ( expected_, empty_entry, std::memory_order_acq_rel ) ) {
+                return false;
+            }
+            bucket_.generations [ i_ ].store ( m_generation, std::memory_order_release );
+            Entry empty = empty_entry;
+            return bucket_.entries [ i_ ].compare_exchange_strong ( empty, entry_, std::memory_order_acq_rel );
+        }
+
+        // Whether the entry (of the generation_) is good, value_ is its (possibly
+        // renumbered) value.
+
+        template<typename Validate>
+        [[ nodiscard ]] bool good ( const Entry entry_, const std::uint8_t generation_, Value & value_, Validate & validate_ ) const {
+            value_ = valueOf ( entry_ );
+            return empty_entry != entry_ and ( m_generation == generation_ or validate_ ( value_, generation_ ) );
+        }
+
+        // The index of the good entry of the key in the bucket, or bucket_size.
+        // An older good entry is revived, the stale ones met are recycled.
+
+        template<typename Validate>
+        [[ nodiscard ]] std::size_t search ( Bucket & bucket_, const std::uint32_t fragment_, Value & value_, Validate & validate_ ) const {
+            for ( std::size_t i = 0u; i < bucket_size; ++i ) {
+                std::uint8_t generation;
+                const Entry entry = read ( bucket_, i, generation );
+                if ( fragmentOf ( entry ) != fragment_ ) {
+                    continue;
+                }
+                if ( m_generation == generation ) {
+                    value_ = valueOf ( entry );
+                    return i;
+                }
+                if ( good ( entry, generation, value_, validate_ ) ) {
+                    if ( write ( bucket_, i, entry, pack ( fragment_, value_ ) ) ) {
+                        m_size.fetch_add ( 1u, std::memory_order_relaxed );
+                        return i;
+                    }
+                }
+                else {
+                    Entry expected = entry;
+                    ( void ) bucket_.entries [ i ].compare_exchange_strong ( expected, empty_entry, std::memory_order_acq_rel );
+                }
+            }
+            return bucket_size;
+        }
+
+    public:
+
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<Key, Value>;
+
+        struct Counters {
+            std::uint64_t hits, misses, collisions;
+        };
+
+        // The weight of an insert without a weight function, all entries weigh
+        // the same.
+
+        struct Unweighted {
+            [[ nodiscard ]] int operator ( ) ( const Value ) const noexcept {
+                return 0;
+            }
+        };
+
+        // The validation without a validate function, the entries of older
+        // generations are stale.
+
+        struct Unvalidated {
+            [[ nodiscard ]] bool operator ( ) ( Value &, const std::uint8_t ) const noexcept {
+                return false;
+            }
+        };
+
+        static constexpr std::size_t default_bytes = 8u * 1'048'576u;
+
+        // The table takes bytes_ (in whole buckets, of 16 up to 2^32 buckets), all
+        // of it up front.
+
+        explicit TranspositionTable ( const Value invalid_, const std::size_t bytes_ = default_bytes ) :
+            m_no_buckets ( std::clamp ( bytes_ / sizeof ( Bucket ), std::size_t { 16 }, std::size_t { 1 } << 32 ) ),
+            m_invalid ( invalid_ ) {
+            m_buckets = std::make_unique<Bucket [ ]> ( m_no_buckets );
+        }
+
+        TranspositionTable ( const TranspositionTable & ) = delete;
+        TranspositionTable & operator = ( const TranspositionTable & ) = delete;
+
+        // Lookup, returns the invalid value if the key is not present.
+
+        template<typename Validate = Unvalidated>
+        [[ nodiscard ]] Value find ( const Key key_, Validate && validate_ = Validate { } ) const {
+            Value value;
+            if ( bucket_size == search ( bucket ( key_ ), fragment ( key_ ), value, validate_ ) ) {
+                m_misses.fetch_add ( 1u, std::memory_order_relaxed );
+                return m_invalid;
+            }
+            m_hits.fetch_add ( 1u, std::memory_order_relaxed );
+            return value;
+        }
+
+        template<typename Validate = Unvalidated>
+        [[ nodiscard ]] bool contains ( const Key key_, Validate && validate_ = Validate { } ) const {
+            Value value;
+            return bucket_size != search ( bucket ( key_ ), fragment ( key_ ), value, validate_ );
+        }
+
+        // Inserts the key with value_, if the key is not present yet. Returns the
+        // value in the table and whether value_ was inserted. The first empty or
+        // stale entry of the bucket is taken, in a full bucket the entry of the
+        // lowest weight_ ( value ) is replaced.
+
+        template<typename Weight = Unweighted, typename Validate = Unvalidated>
+        [[ maybe_unused ]] std::pair<Value, bool> insert ( const Key key_, const Value value_, Weight && weight_ = Weight { }, Validate && validate_ = Validate { } ) {
+            Bucket & bucket = this->bucket ( key_ );
+            const std::uint32_t fragment = this->fragment ( key_ );
+            while ( true ) {
+                Value value;
+                if ( bucket_size != search ( bucket, fragment, value, validate_ ) ) {
+                    return { value, false };
+                }
+                std::size_t victim = bucket_size;
+                Entry entry = empty_entry;
+                bool replace = false;
+                decltype ( weight_ ( value_ ) ) weight { };
+                for ( std::size_t i = 0u; i < bucket_size; ++i ) {
+                    std::uint8_t generation;
+                    const Entry other = read ( bucket, i, generation );
+                    if ( not good ( other, generation, value, validate_ ) ) {
+                        victim = i;
+                        entry = bucket.entries [ i ].load ( std::memory_order_relaxed );
+                        replace = false;
+                        break;
+                    }
+                    const auto other_weight = weight_ ( value );
+                    if ( bucket_size == victim or other_weight < weight ) {
+                        victim = i;
+                        entry = other;
+                        replace = true;
+                        weight = other_weight;
+                    }
+                }
+                if ( write ( bucket, victim, entry, pack ( fragment, value_ ) ) ) {
+                    if ( replace ) {
+                        m_collisions.fetch_add ( 1u, std::memory_order_relaxed );
+                    }
+                    else {
+                        m_size.fetch_add ( 1u, std::memory_order_relaxed );
+                    }
+                    return { value_, true };
+                }
+                // Lost the race for this entry, look again.
+            }
+        }
+
+        // The number of entries written in the current generation (an estimate,
+        // the older entries still good are not counted until revived).
+
+        [[ nodiscard ]] std::size_t size ( ) const noexcept {
+            return m_size.load ( std::memory_order_relaxed );
+        }
+
+        // The number of entries.
+
+        [[ nodiscard ]] std::size_t capacity ( ) const noexcept {
+            return m_no_buckets * bucket_size;
+        }
+
+        [[ nodiscard ]] std::size_t memory ( ) const noexcept {
+            return sizeof ( TranspositionTable ) + m_no_buckets * sizeof ( Bucket );
+        }
+
+        [[ nodiscard ]] Counters counters ( ) const noexcept {
+            return { m_hits.load ( std::memory_order_relaxed ), m_misses.load ( std::memory_order_relaxed ), m_collisions.load ( std::memory_order_relaxed ) };
+        }
+
+        [[ nodiscard ]] std::uint8_t generation ( ) const noexcept {
+            return m_generation;
+        }
+
+        // Not thread-safe, the functions below require exclusive access.
+
+        void clear ( ) noexcept {
+            for ( std::size_t b = 0u; b < m_no_buckets; ++b ) {
+                for ( std::size_t i = 0u; i < bucket_size; ++i ) {
+                    m_buckets [ b ].entries [ i ].store ( empty_entry, std::memory_order_relaxed );
+                }
+            }
+            m_size.store ( 0u, std::memory_order_relaxed );
+        }
+
+        // A new generation, in O ( 1 ), returns it. As the generation wraps, the
+        // entries of 256 generations ago would be taken for current, the table
+        // is cleared instead (and the new generation is 0).
+
+        std::uint8_t nextGeneration ( ) noexcept {
+            if ( 0u == ++m_generation ) {
+                clear ( );
+            }
+            m_size.store ( 0u, std::memory_order_relaxed );
+            return m_generation;
+        }
+
+        // Removes the key (the entries with its fragment, of any generation), if
+        // present.
+
+        [[ maybe_unused ]] bool erase ( const Key key_ ) noexcept {
+            Bucket & bucket = this->bucket ( key_ );
+            const std::uint32_t fragment = this->fragment ( key_ );
+            bool erased = false;
+            for ( std::size_t i = 0u; i < bucket_size; ++i ) {
+                if ( fragmentOf ( bucket.entries [ i ].load ( std::memory_order_relaxed ) ) == fragment ) {
+                    bucket.entries [ i ].store ( empty_entry, std::memory_order_relaxed );
+                    erased = true;
+                }
+            }
+            if ( erased and size ( ) ) {
+                m_size.fetch_sub ( 1u, std::memory_order_relaxed );
+            }
+            return erased;
+        }
+
+        // Sets the value of the key (of any generation, written in the current
+        // one), if present, returns whether it was.
+
+        [[ maybe_unused ]] bool assign ( const Key key_, const Value value_ ) noexcept {
+            Bucket & bucket = this->bucket ( key_ );
+            const std::uint32_t fragment = this->fragment ( key_ );
+            for ( std::size_t i = 0u; i < bucket_size; ++i ) {
+                if ( fragmentOf ( bucket.entries [ i ].load ( std::memory_order_relaxed ) ) == fragment ) {
+                    if ( m_generation != bucket.generations [ i ].load ( std::memory_order_relaxed ) ) {
+                        bucket.generations [ i ].store ( m_generation, std::memory_order_relaxed );
+                        m_size.fetch_add ( 1u, std::memory_order_relaxed );
+                    }
+                    bucket.entries [ i ].store ( pack ( fragment, value_ ), std::memory_order_relaxed );
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The function_ is called with the key and the value of every good entry
+        // (the older ones are not revived). The table holds the fragment and the
+        // bucket index only, the key is the lowest with these, i.e. it finds the
+        // same entry in a table of the same number of buckets (capacity ( ))
+        // only, in any other it's a different key.
+
+        template<typename Function, typename Validate = Unvalidated>
+        void forEach ( Function && function_, Validate && validate_ = Validate { } ) const {
+            for ( std::size_t b = 0u; b < m_no_buckets; ++b ) {
+                const std::uint64_t low = ( ( ( std::uint64_t ) b << 32 ) + m_no_buckets - 1u ) / m_no_buckets;
+                for ( std::size_t i = 0u; i < bucket_size; ++i ) {
+                    const Entry entry = m_buckets [ b ].entries [ i ].load ( std::memory_order_relaxed );
+                    Value value;
+                    if ( good ( entry, m_buckets [ b ].generations [ i ].load ( std::memory_order_relaxed ), value, validate_ ) ) {
+                        function_ ( ( Key ) ( ( std::uint64_t ) fragmentOf ( entry ) << 32 | low ), value );
+                    }
+                }
+            }
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        // Saves the number of buckets and the entries of the current generation,
+        // the keys (as rebuilt by forEach ( ... )) are loaded into a table of the
+        // same number of buckets.
+
+        template < class Archive >
+        void save ( Archive & ar_ ) const {
+            std::uint64_t size = 0u;
+            forEach ( [ & size ] ( Key, Value ) { ++size; } );
+            ar_ ( ( std::uint64_t ) m_no_buckets, size );
+            forEach ( [ & ar_ ] ( Key key_, Value value_ ) { ar_ ( key_, value_ ); } );
+        }
+
+        template < class Archive >
+        void load ( Archive & ar_ ) {
+            std::uint64_t no_buckets, size;
+            ar_ ( no_buckets, size );
+            if ( no_buckets != m_no_buckets ) {
+                m_no_buckets = ( std::size_t ) no_buckets;
+                m_buckets = std::make_unique<Bucket [ ]> ( m_no_buckets );
+            }
+            clear ( );
+            while ( size-- ) {
+                Key key; Value value;
+                ar_ ( key, value );
+                insert ( key, value );
+            }
+        }
+    };
+}
@@ -0,0 +1,151 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <bit>
+#include <random>
+
+#if defined ( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+
+namespace uct {
+
+    // The UCT selection kernel, over the children of one node at a time. The
+    // visits and scores of the children are gathered in (32-byte aligned)
+    // arrays of padded ( n ) elements, the padding lanes are ignored. The
+    // parent log term is computed once. The scores are equal to those of
+    // Mcts::getUCTFromNode ( ... ), with AVX2 or the scalar fallback.
+
+    constexpr std::size_t lanes = 8u;
+
+    [[ nodiscard ]] constexpr std::size_t padded ( const std::size_t n_ ) noexcept {
+        return ( n_ + lanes - 1u ) & ~( lanes - 1u );
+    }
+
+    inline void scores ( const std::int32_t * visits_, const float * scores_, float * uct_, const std::size_t n_, const std::int32_t parent_visits_ ) noexcept {
+        const float c = 4.0f * logf ( ( float ) ( parent_visits_ + 1 ) );
+#if defined ( __AVX2__ )
+        const __m256 c8 = _mm256_set1_ps ( c ), minus_inf = _mm256_set1_ps ( -INFINITY );
+        const __m256i lane = _mm256_setr_epi32 ( 0, 1, 2, 3, 4, 5, 6, 7 );
+        for ( std::size_t i = 0u; i < n_; i += lanes ) {
+            const __m256 visits = _mm256_cvtepi32_ps ( _mm256_load_si256 ( reinterpret_cast<const __m256i *> ( visits_ + i ) ) );
+            const __m256 uct = _mm256_add_ps ( _mm256_div_ps ( _mm256_load_ps ( scores_ + i ), visits ), _mm256_sqrt_ps ( _mm256_div_ps ( c8, visits ) ) );
+            const __m256 valid = _mm256_castsi256_ps ( _mm256_cmpgt_epi32 ( _mm256_set1_epi32 ( ( std::int32_t ) ( n_ - i ) ), lane ) );
+            _mm256_store_ps ( uct_ + i, _mm256_blendv_ps ( minus_inf, uct, valid ) );
+        }
+#else
+        for ( std::size_t i = 0u; i < n_; ++i ) {
+            uct_ [ i ] = scores_ [ i ] / ( float ) visits_ [ i ] + sqrtf ( c / ( float ) visits_ [ i ] );
+        }
+        for ( std::size_t i = n_; i < padded ( n_ ); ++i ) {
+            uct_ [ i ] = -INFINITY;
+        }
+#endif
+    }
+
+    // The index of the highest score, ties are broken uniformly at random.
+
+    template<typename Rng>
+    [[ nodiscard ]] std::size_t argmax ( const float * uct_, const std::size_t n_, Rng & rng_ ) noexcept {
+        std::uint32_t masks [ 64 ], no_ties = 0u;
+        const std::size_t no_chunks = padded ( n_ ) / lanes;
+#if defined ( __AVX2__ )
+        __m256 max = _mm256_load_ps ( uct_ );
+        for ( std::size_t i = lanes; i < n_; i += lanes ) {
+            max = _mm256_max_ps ( max, _mm256_load_ps ( uct_ + i ) );
+        }
+        max = _mm256_max_ps ( max, _mm256_permute2f128_ps ( max, max, 1 ) );
+        max = _mm256_max_ps ( max, _mm256_shuffle_ps ( max, max, _MM_SHUFFLE ( 1, 0, 3, 2 ) ) );
+        max = _mm256_max_ps ( max, _mm256_shuffle_ps ( max, max, _MM_SHUFFLE ( 2, 3, 0, 1 ) ) );
+        for ( std::size_t c = 0u; c < no_chunks; ++c ) {
+            masks [ c ] = ( std::uint32_t ) _mm256_movemask_ps ( _mm256_cmp_ps ( _mm256_load_ps ( uct_ + c * lanes ), max, _CMP_EQ_OQ ) );
+            no_ties += std::popcount ( masks [ c ] );
+        }
+#else
+        float max = uct_ [ 0 ];
+        for ( std::size_t i = 1u; i < n_; ++i ) {
+            if ( uct_ [ i ] > max ) {
+                max = uct_ [ i ];
+            }
+        }
+        for ( std::size_t c = 0u; c < no_chunks; ++c ) {
+            masks [ c ] = 0u;
+            for ( std::size_t l = 0u; l < lanes; ++l ) {
+                masks [ c ] |= std::uint32_t { max == uct_ [ c * lanes + l ] } << l;
+            }
+            no_ties += std::popcount ( masks [ c ] );
+        }
+#endif
+        // The k-th tie, in order of the children.
+        std::uint32_t k = no_ties > 1u ? ( std::uint32_t ) std::uniform_int_distribution<std::ptrdiff_t> ( 0, no_ties - 1 ) ( rng_ ) : 0u;
+        std::size_t c = 0u;
+        while ( k >= ( std::uint32_t ) std::popcount ( masks [ c ] ) ) {
+            k -= std::popcount ( masks [ c++ ] );
+        }
+        std::uint32_t mask = masks [ c ];
+        while ( k-- ) {
+            mask &= mask - 1u;
+        }
+        return c * lanes + std::countr_zero ( mask );
+    }
+
+    template<typename Rng>
+    [[ nodiscard ]] std::size_t select ( const std::int32_t * visits_, const float * scores_, const std::size_t n_, const std::int32_t parent_visits_, Rng & rng_ ) noexcept {
+        alignas ( 32 ) float uct [ 512 ];
+        scores ( visits_, scores_, uct, n_, parent_visits_ );
+        return argmax ( uct, n_, rng_ );
+    }
+
+    // The per child evaluation the kernel replaced (a logf, a sqrtf and two
+    // divisions per child, the ties collected as they come), for the benchmark
+    // and the checks. Selects the same child as select ( ... ), given the same
+    // rng_.
+
+    template<typename Rng>
+    [[ nodiscard ]] std::size_t selectPerChild ( const std::int32_t * visits_, const float * scores_, const std::size_t n_, const std::int32_t parent_visits_, Rng & rng_ ) noexcept {
+        std::size_t best [ 512 ], no_best = 1u;
+        best [ 0 ] = 0u;
+        float best_score = scores_ [ 0 ] / ( float ) visits_ [ 0 ] + sqrtf ( 4.0f * logf ( ( float ) ( parent_visits_ + 1 ) ) / ( float ) visits_ [ 0 ] );
+        for ( std::size_t i = 1u; i < n_; ++i ) {
+            const float score = scores_ [ i ] / ( float ) visits_ [ i ] + sqrtf ( 4.0f * logf ( ( float ) ( parent_visits_ + 1 ) ) / ( float ) visits_ [ i ] );
+            if ( score > best_score ) {
+                best [ 0 ] = i;
+                no_best = 1u;
+                best_score = score;
+            }
+            else if ( score == best_score ) {
+                best [ no_best++ ] = i;
+            }
+        }
+        // Ties are broken by fair coin flips.
+        return 1u == no_best ? best [ 0 ] : best [ std::uniform_int_distribution<std::ptrdiff_t> ( 0, ( std::ptrdiff_t ) no_best - 1 ) ( rng_ ) ];
+    }
+}
@@ -0,0 +1,450 @@
+
+// MIT License
+//
+// Copyright (c) 2018 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <bit>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <cereal/cereal.hpp>
+
+#include "owningptr.hpp"
+#include "pool_allocator.hpp"
+#include "indexed_pool.hpp"
+
+#include "Typedefs.hpp"
+#include "Globals.hpp"
+
+
+namespace mcts {
+
+    class SpinLock {
+
+        std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+
+    public:
+
+        void lock ( ) noexcept {
+            while ( m_flag.test_and_set ( std::memory_order_acquire ) ) {
+                std::this_thread::yield ( );
+            }
+        }
+
+        void unlock ( ) noexcept {
+            m_flag.clear ( std::memory_order_release );
+        }
+    };
+
+
+    // The hook, a State specializes untried_bitmask<State> as std::true_type if
+    // the untried moves of a node can be tracked by a bitmask over the order in
+    // which State::moves ( ) generates them, i.e. if that order is a function
+    // of the position only (transpositions share a node, the move history
+    // must not matter) and there are at most 64 moves. The moves are then
+    // generated again when one is drawn, instead of being stored (in a pool)
+    // per node.
+
+    template<typename State>
+    struct untried_bitmask : std::false_type { };
+
+
+    // The untried moves of a node, all variants have the same interface: any ( ),
+    // draw ( state, rng ), reset ( state ), retain ( other ), copy, move and
+    // serialization. The state passed in is the state of the node.
+
+    // In a Moves object from a pool shared by all trees (trees are grown
+    // concurrently in parallel searches, hence the pool is guarded), the Moves
+    // object is released on drawing the last move.
+
+    template<typename State>
+    class PooledMoves { // 8 bytes.
+
+    public:
+
+        using Moves = typename State::Moves;
+        using Move = typename Moves::value_type;
+        using MovesPool = pa::pool_allocator<Moves>;
+        using MovesPoolPtr = llvm::OwningPtr<MovesPool>;
+
+    private:
+
+        Moves * m_moves = nullptr;
+
+        template<typename ... Args>
+        [[ nodiscard ]] static Moves * newMoves ( Args && ... args_ ) noexcept {
+            s_moves_pool_lock.lock ( );
+            Moves * moves = s_moves_pool->new_element ( std::forward<Args> ( args_ ) ... );
+            s_moves_pool_lock.unlock ( );
+            return moves;
+        }
+
+        static void deleteMoves ( Moves * moves_ ) noexcept {
+            if ( nullptr != moves_ ) {
+                s_moves_pool_lock.lock ( );
+                s_moves_pool->delete_element ( moves_ );
+                s_moves_pool_lock.unlock ( );
+            }
+        }
+
+    public:
+
+        static MovesPoolPtr s_moves_pool;
+        static SpinLock s_moves_pool_lock;
+
+        PooledMoves ( ) noexcept { }
+        explicit PooledMoves ( const State & state_ ) noexcept {
+            reset ( state_ );
+        }
+        PooledMoves ( const PooledMoves & pm_ ) noexcept {
+            if ( nullptr != pm_.m_moves ) {
+                m_moves = newMoves ( * pm_.m_moves );
+            }
+        }
+        PooledMoves ( PooledMoves && pm_ ) noexcept {
+            std::swap ( m_moves, pm_.m_moves );
+        }
+
+        ~PooledMoves ( ) noexcept {
+            deleteMoves ( m_moves );
+        }
+
+        [[ maybe_unused ]] PooledMoves & operator = ( const PooledMoves & pm_ ) noexcept {
+            if ( this != & pm_ ) {
+                deleteMoves ( m_moves );
+                m_moves = nullptr != pm_.m_moves ? newMoves ( * pm_.m_moves ) : nullptr;
+            }
+            return * this;
+        }
+
+        [[ maybe_unused ]] PooledMoves & operator = ( PooledMoves && pm_ ) noexcept {
+            std::swap ( m_moves, pm_.m_moves );
+            return * this;
+        }
+
+        [[ nodiscard ]] bool any ( ) const noexcept {
+            return nullptr != m_moves;
+        }
+
+        // Returns the pages of the pool that hold free Moves objects only to the
+        // OS, returns the number of bytes released.
+
+        static std::size_t releaseFreePages ( ) noexcept {
+            s_moves_pool_lock.lock ( );
+            const std::size_t released = s_moves_pool->release_free_pages ( );
+            s_moves_pool_lock.unlock ( );
+            return released;
+        }
+
+        [[ nodiscard ]] Move draw ( const State &, rng_t & rng_ ) noexcept {
+            if ( 1 == m_moves->size ( ) ) {
+                // 1 move left, so destroy memory and return that 1 move.
+                const Move move = m_moves->front ( );
+                deleteMoves ( m_moves );
+                m_moves = nullptr;
+                return move;
+            }
+            return m_moves->draw ( rng_ );
+        }
+
+        void reset ( const State & state_ ) noexcept {
+            deleteMoves ( m_moves );
+            m_moves = newMoves ( );
+            if ( not ( state_.moves ( m_moves ) ) ) {
+                deleteMoves ( m_moves );
+                m_moves = nullptr;
+            }
+        }
+
+        // Keeps the moves that are untried in rhs_ (of the same position) as well.
+        void retain ( const PooledMoves & rhs_ ) noexcept {
+            if ( nullptr == m_moves ) {
+                return;
+            }
+            if ( nullptr != rhs_.m_moves ) {
+                for ( index_t i = m_moves->size ( ) - 1; i >= 0; --i ) {
+                    if ( not ( rhs_.m_moves->find ( m_moves->at ( i ) ) ) ) {
+                        m_moves->remove ( m_moves->at ( i ) );
+                    }
+                }
+                if ( not ( m_moves->empty ( ) ) ) {
+                    return;
+                }
+            }
+            deleteMoves ( m_moves );
+            m_moves = nullptr;
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void save ( Archive & ar_ ) const noexcept {
+            const std::int8_t tmp = nullptr != m_moves ? 2 : 1;
+            ar_ ( tmp );
+            if ( nullptr != m_moves ) {
+                m_moves->serialize ( ar_ );
+            }
+        }
+
+        template < class Archive >
+        void load ( Archive & ar_ ) noexcept {
+            std::int8_t tmp = -1;
+            ar_ ( tmp );
+            deleteMoves ( m_moves );
+            m_moves = nullptr;
+            if ( 2 == tmp ) {
+                m_moves = newMoves ( );
+                m_moves->serialize ( ar_ );
+            }
+        }
+    };
+
+    template<typename State>
+    typename PooledMoves<State>::MovesPoolPtr PooledMoves<State>::s_moves_pool ( new MovesPool ( ) );
+
+    template<typename State>
+    SpinLock PooledMoves<State>::s_moves_pool_lock;
+
+
+    // As PooledMoves, by a 32-bit handle into an indexed pool instead of by pointer.
+
+    template<typename State>
+    class IndexedMoves { // 4 bytes.
+
+    public:
+
+        using Moves = typename State::Moves;
+        using Move = typename Moves::value_type;
+        using MovesPool = pa::indexed_pool<Moves>;
+        using MovesHandle = typename MovesPool::handle_type;
+
+    private:
+
+        MovesHandle m_moves = MovesPool::null_handle;
+
+        template<typename ... Args>
+        [[ nodiscard ]] static MovesHandle newMoves ( Args && ... args_ ) noexcept {
+            s_moves_pool_lock.lock ( );
+            const MovesHandle moves = s_moves_pool.new_element ( std::forward<Args> ( args_ ) ... );
+            s_moves_pool_lock.unlock ( );
+            return moves;
+        }
+
+        static void deleteMoves ( const MovesHandle moves_ ) noexcept {
+            if ( MovesPool::null_handle != moves_ ) {
+                s_moves_pool_lock.lock ( );
+                s_moves_pool.delete_element ( moves_ );
+                s_moves_pool_lock.unlock ( );
+            }
+        }
+
+    public:
+
+        static MovesPool s_moves_pool;
+        static SpinLock s_moves_pool_lock;
+
+        IndexedMoves ( ) noexcept { }
+        explicit IndexedMoves ( const State & state_ ) noexcept {
+            reset ( state_ );
+        }
+        IndexedMoves ( const IndexedMoves & im_ ) noexcept {
+            if ( MovesPool::null_handle != im_.m_moves ) {
+                m_moves = newMoves ( s_moves_pool [ im_.m_moves ] );
+            }
+        }
+        IndexedMoves ( IndexedMoves && im_ ) noexcept {
+            std::swap ( m_moves, im_.m_moves );
+        }
+
+        ~IndexedMoves ( ) noexcept {
+            deleteMoves ( m_moves );
+        }
+
+        [[ maybe_unused ]] IndexedMoves & operator = ( const IndexedMoves & im_ ) noexcept {
+            if ( this != & im_ ) {
+                deleteMoves ( m_moves );
+                m_moves = MovesPool::null_handle != im_.m_moves ? newMoves ( s_moves_pool [ im_.m_moves ] ) : MovesPool::null_handle;
+            }
+            return * this;
+        }
+
+        [[ maybe_unused ]] IndexedMoves & operator = ( IndexedMoves && im_ ) noexcept {
+            std::swap ( m_moves, im_.m_moves );
+            return * this;
+        }
+
+        [[ nodiscard ]] bool any ( ) const noexcept {
+            return MovesPool::null_handle != m_moves;
+        }
+
+        [[ nodiscard ]] Move draw ( const State &, rng_t & rng_ ) noexcept {
+            Moves & moves = s_moves_pool [ m_moves ];
+            if ( 1 == moves.size ( ) ) {
+                const Move move = moves.front ( );
+                deleteMoves ( m_moves );
+                m_moves = MovesPool::null_handle;
+                return move;
+            }
+            return moves.draw ( rng_ );
+        }
+
+        void reset ( const State & state_ ) noexcept {
+            deleteMoves ( m_moves );
+            m_moves = newMoves ( );
+            if ( not ( state_.moves ( & s_moves_pool [ m_moves ] ) ) ) {
+                deleteMoves ( m_moves );
+                m_moves = MovesPool::null_handle;
+            }
+        }
+
+        // Keeps the moves that are untried in rhs_ (of the same position) as well.
+        void retain ( const IndexedMoves & rhs_ ) noexcept {
+            if ( MovesPool::null_handle == m_moves ) {
+                return;
+            }
+            if ( MovesPool::null_handle != rhs_.m_moves ) {
+                Moves & moves = s_moves_pool [ m_moves ];
+                const Moves & rhs_moves = s_moves_pool [ rhs_.m_moves ];
+                for ( index_t i = moves.size ( ) - 1; i >= 0; --i ) {
+                    if ( not ( rhs_moves.find ( moves.at ( i ) ) ) ) {
+                        moves.remove ( moves.at ( i ) );
+                    }
+                }
+                if ( not ( moves.empty ( ) ) ) {
+                    return;
+                }
+            }
+            deleteMoves ( m_moves );
+            m_moves = MovesPool::null_handle;
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void save ( Archive & ar_ ) const noexcept {
+            const std::int8_t tmp = MovesPool::null_handle != m_moves ? 2 : 1;
+            ar_ ( tmp );
+            if ( MovesPool::null_handle != m_moves ) {
+                s_moves_pool [ m_moves ].serialize ( ar_ );
+            }
+        }
+
+        template < class Archive >
+        void load ( Archive & ar_ ) noexcept {
+            std::int8_t tmp = -1;
+            ar_ ( tmp );
+            deleteMoves ( m_moves );
+            m_moves = MovesPool::null_handle;
+            if ( 2 == tmp ) {
+                m_moves = newMoves ( );
+                s_moves_pool [ m_moves ].serialize ( ar_ );
+            }
+        }
+    };
+
+    template<typename State>
+    typename IndexedMoves<State>::MovesPool IndexedMoves<State>::s_moves_pool;
+
+    template<typename State>
+    SpinLock IndexedMoves<State>::s_moves_pool_lock;
+
+
+    // A bit per move, in the order of State::moves ( ), no allocation. Drawing
+    // generates the moves of the state again and picks one of the set bits.
+
+    template<typename State>
+    class BitmaskMoves { // 1, 2, 4 or 8 bytes.
+
+    public:
+
+        using Moves = typename State::Moves;
+        using Move = typename Moves::value_type;
+
+        static_assert ( State::max_no_moves <= 64, "a bitmask holds up to 64 moves" );
+
+        using Mask = std::conditional_t<State::max_no_moves <= 8, std::uint8_t,
+                     std::conditional_t<State::max_no_moves <= 16, std::uint16_t,
+                     std::conditional_t<State::max_no_moves <= 32, std::uint32_t, std::uint64_t>>>;
+
+    private:
+
+        Mask m_untried = 0u;
+
+    public:
+
+        BitmaskMoves ( ) noexcept { }
+        explicit BitmaskMoves ( const State & state_ ) noexcept {
+            reset ( state_ );
+        }
+
+        [[ nodiscard ]] bool any ( ) const noexcept {
+            return m_untried;
+        }
+
+        [[ nodiscard ]] Move draw ( const State & state_, rng_t & rng_ ) noexcept {
+            Moves moves;
+            ( void ) state_.moves ( & moves );
+            // Pick the k-th set bit.
+            Mask untried = m_untried;
+            for ( int k = std::uniform_int_distribution<int> ( 0, std::popcount ( m_untried ) - 1 ) ( rng_ ); k > 0; --k ) {
+                untried &= untried - 1u;
+            }
+            const int i = std::countr_zero ( untried );
+            m_untried &= ~( Mask { 1 } << i );
+            return moves.at ( i );
+        }
+
+        void reset ( const State & state_ ) noexcept {
+            Moves moves;
+            m_untried = state_.moves ( & moves ) and moves.size ( ) ? ( Mask ) ( ~std::uint64_t { 0 } >> ( 64 - moves.size ( ) ) ) : Mask { 0 };
+        }
+
+        // Keeps the moves that are untried in rhs_ (of the same position) as well.
+        void retain ( const BitmaskMoves & rhs_ ) noexcept {
+            m_untried &= rhs_.m_untried;
+        }
+
+    private:
+
+        friend class cereal::access;
+
+        template < class Archive >
+        void serialize ( Archive & ar_ ) {
+            ar_ ( m_untried );
+        }
+    };
+
+
+    template<typename State, template<typename> typename Fallback>
+    using UntriedMoves = std::conditional_t<untried_bitmask<State>::value, BitmaskMoves<State>, Fallback<State>>;
+}